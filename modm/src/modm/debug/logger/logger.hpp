@@ -51,6 +51,14 @@ namespace modm
 				{
 				}
 
+				/// Logger with a fixed choice of `float` formatting,
+				/// e.g. `FloatFormat::Fixed` for cheap telemetry output.
+				Logger(::modm::IODevice& outputDevice, FloatFormat floatFormat, uint8_t floatPrecision) :
+					IOStream(outputDevice)
+				{
+					this->setFloatFormat(floatFormat, floatPrecision);
+				}
+
 				/**
 				 * @brief	Output forwarding
 				 *
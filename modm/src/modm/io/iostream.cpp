@@ -25,7 +25,9 @@ FLASH_STORAGE(uint16_t base[]) = { 10, 100, 1000, 10000 };
 // ----------------------------------------------------------------------------
 modm::IOStream::IOStream(IODevice& outputDevice) :
 	device(&outputDevice),
-	mode(Mode::Ascii)
+	mode(Mode::Ascii),
+	floatFormat(FloatFormat::Scientific),
+	floatPrecision(5)
 {
 }
 
@@ -134,6 +134,54 @@ public:
 		return *this;
 	}
 
+	/// Formatting used for `float` and `double`
+	enum class
+	FloatFormat : uint8_t
+	{
+		Scientific,	///< `d.ddddde+xx`, `precision` digits after the point
+		Fixed,		///< `ddd.ddddd`, `precision` digits after the point
+	};
+
+	/// Largest supported number of digits after the decimal point
+	static constexpr uint8_t maxFloatPrecision = 6;
+
+	/// format `float` and `double` as `d.ddddde+xx`
+	modm_always_inline IOStream&
+	scientific(uint8_t precision = 5)
+	{
+		return this->setFloatFormat(FloatFormat::Scientific, precision);
+	}
+
+	/// format `float` and `double` as `ddd.ddddd`
+	///
+	/// Values whose magnitude does not fit into 32 bits at the given
+	/// precision fall back to scientific notation.
+	modm_always_inline IOStream&
+	fixed(uint8_t precision = 5)
+	{
+		return this->setFloatFormat(FloatFormat::Fixed, precision);
+	}
+
+	modm_always_inline IOStream&
+	setFloatFormat(FloatFormat format, uint8_t precision)
+	{
+		this->floatFormat = format;
+		this->floatPrecision = (precision < maxFloatPrecision) ? precision : maxFloatPrecision;
+		return *this;
+	}
+
+	modm_always_inline FloatFormat
+	getFloatFormat() const
+	{
+		return this->floatFormat;
+	}
+
+	modm_always_inline uint8_t
+	getFloatPrecision() const
+	{
+		return this->floatPrecision;
+	}
+
 
 	IOStream&
 	operator << (const unsigned char& v)
@@ -433,6 +481,15 @@ protected:
 	void
 	writeFloat(const float& value);
 
+	void
+	writeFloatScientific(float value);
+
+	void
+	writeFloatFixed(float value);
+
+	void
+	writeDigits(uint32_t value, uint_fast8_t numDigits);
+
 #if not defined(MODM_CPU_AVR)
 	void
 	writeDouble(const double& value);
@@ -463,6 +520,8 @@ private:
 private:
 	IODevice* const	device;
 	Mode mode;
+	FloatFormat floatFormat;
+	uint8_t floatPrecision;
 };
 
 /// @ingroup modm_io
@@ -504,6 +563,20 @@ ascii(IOStream& ios)
 	return ios.ascii();
 }
 
+/// format `float` and `double` in scientific notation, keeping the precision
+inline IOStream&
+scientific(IOStream& ios)
+{
+	return ios.setFloatFormat(IOStream::FloatFormat::Scientific, ios.getFloatPrecision());
+}
+
+/// format `float` and `double` in fixed-point notation, keeping the precision
+inline IOStream&
+fixed(IOStream& ios)
+{
+	return ios.setFloatFormat(IOStream::FloatFormat::Fixed, ios.getFloatPrecision());
+}
+
 /// Set the foreground colour on ANSI terminals.
 inline IOStream&
 black(IOStream& ios)
@@ -18,101 +18,207 @@
 #include <stdio.h>		// snprintf()
 #include <stdlib.h>
 #include <cmath>
+#include <cstring>
 
 #include <modm/math/utils/arithmetic_traits.hpp>
 
 #include "iostream.hpp"
 
+namespace
+{
+	constexpr int32_t minDecimalExponent = -38;
+	constexpr int32_t maxDecimalExponent = 38;
+
+	// 10^-38 ... 10^38, every power of ten representable as a normal float
+	const float powersOfTen[] =
+	{
+		1e-38f, 1e-37f, 1e-36f, 1e-35f, 1e-34f, 1e-33f, 1e-32f, 1e-31f,
+		1e-30f, 1e-29f, 1e-28f, 1e-27f, 1e-26f, 1e-25f, 1e-24f, 1e-23f,
+		1e-22f, 1e-21f, 1e-20f, 1e-19f, 1e-18f, 1e-17f, 1e-16f, 1e-15f,
+		1e-14f, 1e-13f, 1e-12f, 1e-11f, 1e-10f, 1e-9f, 1e-8f, 1e-7f, 1e-6f,
+		1e-5f, 1e-4f, 1e-3f, 1e-2f, 1e-1f, 1e0f, 1e1f, 1e2f, 1e3f, 1e4f, 1e5f,
+		1e6f, 1e7f, 1e8f, 1e9f, 1e10f, 1e11f, 1e12f, 1e13f, 1e14f, 1e15f,
+		1e16f, 1e17f, 1e18f, 1e19f, 1e20f, 1e21f, 1e22f, 1e23f, 1e24f, 1e25f,
+		1e26f, 1e27f, 1e28f, 1e29f, 1e30f, 1e31f, 1e32f, 1e33f, 1e34f, 1e35f,
+		1e36f, 1e37f, 1e38f
+	};
+	static_assert(sizeof(powersOfTen) / sizeof(float) == maxDecimalExponent - minDecimalExponent + 1);
+
+	const uint32_t integerPowersOfTen[] =
+	{
+		1, 10, 100, 1000, 10000, 100000, 1000000, 10000000
+	};
+	static_assert(sizeof(integerPowersOfTen) / sizeof(uint32_t) > modm::IOStream::maxFloatPrecision + 1);
+
+	inline float
+	powerOfTen(int32_t exponent)
+	{
+		return powersOfTen[exponent - minDecimalExponent];
+	}
+
+	/// floor(log10(value)) for a finite, normal, positive value.
+	///
+	/// The binary exponent narrows the result down to two candidates, one
+	/// comparison against the table picks the right one.
+	inline int32_t
+	decimalExponent(float value)
+	{
+		uint32_t bits;
+		std::memcpy(&bits, &value, sizeof(bits));
+		const int32_t binaryExponent = static_cast<int32_t>((bits >> 23) & 0xff) - 127;
+
+		// 1233 / 4096 ~= log10(2), exact enough for all float exponents
+		int32_t exponent = (binaryExponent * 1233) >> 12;
+		if (exponent < maxDecimalExponent and value >= powerOfTen(exponent + 1)) {
+			exponent += 1;
+		}
+		return exponent;
+	}
+
+	/// Rounds a non-negative value to the nearest integer. From 2^23 on
+	/// floats are whole numbers, adding 0.5 would round them a second time.
+	inline uint32_t
+	roundToInteger(float value)
+	{
+		return static_cast<uint32_t>((value < 8388608.f) ? value + 0.5f : value);
+	}
+}
+
 void
 modm::IOStream::writeFloat(const float& value)
 {
-	// hard coded for -2.22507e-308
-	char str[13 + 1]; // +1 for '\0'
-
 	if(!std::isfinite(value)) {
-		char *ptr = &str[0];
 		if(std::isinf(value)) {
-			if (value < 0) {
-				*ptr++ = '-';
-			}
-			*ptr++ = 'i';
-			*ptr++ = 'n';
-			*ptr++ = 'f';
-			*ptr++ = '\0';	// End of string
-			this->device->write(str);
-			return;
+			this->device->write((value < 0) ? "-inf" : "inf");
 		}
 		else {
-			*ptr++ = 'n';
-			*ptr++ = 'a';
-			*ptr++ = 'n';
-			*ptr++ = '\0';	// End of string
-			this->device->write(str);
-			return;
+			this->device->write("nan");
 		}
+		return;
 	}
 
 #if defined(MODM_CPU_AVR)
+	// hard coded for -2.22507e-308
+	char str[13 + 1]; // +1 for '\0'
 	dtostre(value, str, 5, 0);
 	this->device->write(str);
 #elif defined(MODM_CPU_CORTEX_M4) || defined(MODM_CPU_CORTEX_M3) || defined(MODM_CPU_CORTEX_M0) || defined(MODM_OS_WIN32)
-	float v;
-	char *ptr = &str[0];
-
+	float v = value;
 	if (value < 0) {
 		v = -value;
-		*ptr++ = '-';
+		this->device->write('-');
+	}
+
+	if (this->floatFormat == FloatFormat::Fixed) {
+		this->writeFloatFixed(v);
 	}
 	else {
-		v = value;
+		this->writeFloatScientific(v);
 	}
+#else
+	char str[48];
+	snprintf(str, sizeof(str), (this->floatFormat == FloatFormat::Fixed) ? "%.*f" : "%.*e",
+			static_cast<int>(this->floatPrecision), (double) value);
+	this->device->write(str);
+#endif
+}
 
-	int32_t ep = 0;
-	if (v != 0)
+// ----------------------------------------------------------------------------
+void
+modm::IOStream::writeFloatScientific(float value)
+{
+	const uint_fast8_t precision = this->floatPrecision;
+	int32_t exponent = 0;
+	uint32_t digits = 0;
+
+	if (value != 0)
 	{
-		while (v < 1.f) {
-			v *= 10;
-			ep -= 1;
+		// Lift the smallest values and subnormals, so that the scale
+		// factor below is in the table
+		int32_t exponentOffset = 0;
+		if (value < 1e-20f) {
+			value *= 1e20f;
+			exponentOffset = -20;
 		}
 
-		while (v > 10) {
-			v *= 0.1f;
-			ep += 1;
-		}
-	}
+		exponent = decimalExponent(value);
 
-	for (uint32_t i = 0; i < 6; ++i)
-	{
-		int8_t num = static_cast<int8_t>(v);
-		*ptr++ = (num + '0');
+		// Scale to an integer with (precision + 1) digits in one step. A
+		// mantissa in [1, 10) as a float first would lose a digit at
+		// precision 6.
+		digits = roundToInteger(value * powerOfTen(precision - exponent));
 
-		if (i == 0) {
-			*ptr++ = '.';
+		if (digits >= integerPowersOfTen[precision + 1]) {
+			// Rounding carried into a new digit, e.g. 9.999999 -> 10.00000
+			digits = integerPowersOfTen[precision];
+			exponent += 1;
+		}
+		else if (digits < integerPowersOfTen[precision]) {
+			// Table rounding left the mantissa just below 1
+			digits = integerPowersOfTen[precision];
 		}
 
-		// next digit
-		v = (v - num) * 10;
+		exponent += exponentOffset;
 	}
 
-	*ptr++ = 'e';
-	if (ep < 0) {
-		ep = -ep;
-		*ptr++ = '-';
+	const uint32_t leadingDigit = digits / integerPowersOfTen[precision];
+	this->device->write(static_cast<char>(leadingDigit) + '0');
+	if (precision > 0) {
+		this->device->write('.');
+		this->writeDigits(digits - leadingDigit * integerPowersOfTen[precision], precision);
+	}
+
+	this->device->write('e');
+	if (exponent < 0) {
+		exponent = -exponent;
+		this->device->write('-');
 	}
 	else {
-		*ptr++ = '+';
+		this->device->write('+');
 	}
-	if (ep < 10) {
-		*ptr++ = '0';
+	this->writeDigits(exponent, 2);
+}
+
+void
+modm::IOStream::writeFloatFixed(float value)
+{
+	const uint_fast8_t precision = this->floatPrecision;
+
+	const float scaled = value * integerPowersOfTen[precision];
+	if (not (scaled < 4294967296.f)) {
+		// Does not fit into the fixed point representation
+		this->writeFloatScientific(value);
+		return;
 	}
-	*ptr++ = '\0';	// End of string
-	this->device->write(str);
 
-	this->writeInteger(ep);
-#else
-	snprintf(str, sizeof(str), "%.5e", (double) value);
-	this->device->write(str);
-#endif
+	const uint32_t fixedPoint = roundToInteger(scaled);
+	const uint32_t integerPart = fixedPoint / integerPowersOfTen[precision];
+	this->writeInteger(integerPart);
+	if (precision > 0) {
+		this->device->write('.');
+		this->writeDigits(fixedPoint - integerPart * integerPowersOfTen[precision], precision);
+	}
+}
+
+void
+modm::IOStream::writeDigits(uint32_t value, uint_fast8_t numDigits)
+{
+	char buffer[ArithmeticTraits<uint32_t>::decimalDigits + 1]; // +1 for '\0'
+	if (numDigits > ArithmeticTraits<uint32_t>::decimalDigits) {
+		numDigits = ArithmeticTraits<uint32_t>::decimalDigits;
+	}
+
+	// Exactly numDigits digits, zero-padded, filled backwards
+	char *ptr = buffer + numDigits;
+	*ptr = '\0';
+	while (ptr != buffer) {
+		uint32_t quot = value / 10;
+		uint8_t rem = value - quot*10;
+		*(--ptr) = static_cast<char>(rem) + '0';
+		value = quot;
+	}
+
+	this->device->write(buffer);
 }
 
 // ----------------------------------------------------------------------------
@@ -124,9 +230,9 @@ modm::IOStream::writeDouble(const double& value)
 	// TODO do this better
 	writeFloat(static_cast<float>(value));
 #else
-	// hard coded for 2.22507e-308
-	char str[13 + 1]; // +1 for '\0'
-	snprintf(str, sizeof(str), "%.5e", value);
+	char str[48];
+	snprintf(str, sizeof(str), (this->floatFormat == FloatFormat::Fixed) ? "%.*f" : "%.*e",
+			static_cast<int>(this->floatPrecision), value);
 	this->device->write(str);
 #endif
 }
@@ -0,0 +1,130 @@
+# Host build of the tools in src/tools, sharing the pipeline code in src/app
+# with the firmware. Configure with -DHOST_BUILD=ON.
+
+SET(CMAKE_CXX_STANDARD 17)
+SET(CMAKE_CXX_STANDARD_REQUIRED ON)
+SET(CMAKE_CXX_EXTENSIONS OFF)
+
+IF(NOT CMAKE_BUILD_TYPE)
+	SET(CMAKE_BUILD_TYPE Release)
+ENDIF()
+
+SET(HOST_CCFLAGS "\
+    -W \
+    -Wall \
+    -Wduplicated-cond \
+    -Werror=format \
+    -Werror=maybe-uninitialized \
+    -Werror=overflow \
+    -Werror=sign-compare \
+    -Wextra \
+    -Wlogical-op \
+    -Wpointer-arith \
+")
+
+SET(CMAKE_C_FLAGS "${CMAKE_C_FLAGS} ${HOST_CCFLAGS}")
+SET(CMAKE_CXX_FLAGS "${CMAKE_CXX_FLAGS} ${HOST_CCFLAGS}")
+
+INCLUDE_DIRECTORIES(
+	modm/ext/cmsis/core
+	modm/ext/cmsis/dsp
+	gcem/include
+	src
+)
+
+MESSAGE(STATUS "Build type: ${CMAKE_BUILD_TYPE}")
+MESSAGE(STATUS "Build dir: ${PROJECT_BINARY_DIR}")
+
+# The parts of CMSIS-DSP the front end uses, built as portable C. The bit
+# reversal is assembly on the target, src/host has a C version of it.
+SET(HOST_DSP_SRC
+	modm/ext/cmsis/dsp/TransformFunctions/arm_rfft_fast_f32.c
+	modm/ext/cmsis/dsp/TransformFunctions/arm_rfft_fast_init_f32.c
+	modm/ext/cmsis/dsp/TransformFunctions/arm_cfft_f32.c
+	modm/ext/cmsis/dsp/TransformFunctions/arm_cfft_radix8_f32.c
+	modm/ext/cmsis/dsp/CommonTables/arm_common_tables.c
+	modm/ext/cmsis/dsp/CommonTables/arm_const_structs.c
+	modm/ext/cmsis/dsp/ComplexMathFunctions/arm_cmplx_mag_squared_f32.c
+	src/host/arm_bitreversal.c
+)
+ADD_LIBRARY(lpsr-dsp STATIC ${HOST_DSP_SRC})
+# arm_math.h needs a target architecture, the float code paths are plain C
+TARGET_COMPILE_DEFINITIONS(lpsr-dsp PUBLIC __ARM_ARCH_7EM__)
+TARGET_COMPILE_OPTIONS(lpsr-dsp PRIVATE -w -ffunction-sections -fdata-sections)
+# Also linked into the shared library below
+SET_TARGET_PROPERTIES(lpsr-dsp PROPERTIES POSITION_INDEPENDENT_CODE ON)
+
+FIND_PACKAGE(Threads REQUIRED)
+
+GET_SOURCES(HOST_SRC src/host)
+LIST(REMOVE_ITEM HOST_SRC ${CMAKE_CURRENT_SOURCE_DIR}/src/host/arm_bitreversal.c)
+ADD_LIBRARY(lpsr-host STATIC ${HOST_SRC})
+TARGET_LINK_LIBRARIES(lpsr-host lpsr-dsp Threads::Threads)
+
+# The streaming recognizer's C API (src/host/lpsr.h) for embedding in other programs
+ADD_LIBRARY(lpsr SHARED src/host/lpsr.cpp)
+# Keeps the CMSIS-DSP symbols private
+TARGET_LINK_LIBRARIES(lpsr lpsr-dsp "-Wl,--exclude-libs,ALL")
+SET_TARGET_PROPERTIES(lpsr PROPERTIES CXX_VISIBILITY_PRESET hidden VISIBILITY_INLINES_HIDDEN ON)
+
+MACRO(ADD_HOST_TOOL NAME)
+	ADD_EXECUTABLE(${NAME} src/tools/${NAME}.cpp)
+	TARGET_LINK_LIBRARIES(${NAME} lpsr-host "-Wl,--gc-sections")
+	MESSAGE(STATUS "added ${NAME}")
+ENDMACRO(ADD_HOST_TOOL)
+
+ADD_HOST_TOOL(frame_sim)
+ADD_HOST_TOOL(template_info)
+ADD_HOST_TOOL(enroll_tool)
+ADD_HOST_TOOL(template_builder)
+ADD_HOST_TOOL(evaluate)
+ADD_HOST_TOOL(session_convert)
+ADD_HOST_TOOL(batch_features)
+ADD_HOST_TOOL(stream_recognize)
+ADD_HOST_TOOL(stream_bench)
+ADD_HOST_TOOL(engine_bench)
+ADD_HOST_TOOL(kernel_bench)
+ADD_HOST_TOOL(frontend_compare)
+ADD_HOST_TOOL(memory_plan)
+# Reports the RAM plan with every build, and fails it if a buffer is read after reuse
+ADD_CUSTOM_COMMAND(TARGET memory_plan POST_BUILD COMMAND memory_plan)
+
+# The host tests in src/tests, run by ctest
+ENABLE_TESTING()
+
+MACRO(ADD_HOST_TEST NAME)
+	ADD_EXECUTABLE(${NAME} src/tests/${NAME}.cpp)
+	TARGET_LINK_LIBRARIES(${NAME} lpsr-host)
+	ADD_TEST(NAME ${NAME} COMMAND ${NAME})
+ENDMACRO(ADD_HOST_TEST)
+
+ADD_HOST_TEST(spsc_queue_test)
+ADD_HOST_TEST(fast_log2_test)
+ADD_HOST_TEST(telemetry_test)
+ADD_HOST_TEST(enrollment_test)
+
+# modm's IOStream, which builds for the host as it is
+ADD_LIBRARY(lpsr-modm-io STATIC
+	modm/src/modm/io/iodevice.cpp
+	modm/src/modm/io/iostream.cpp
+	modm/src/modm/io/iostream_float.cpp
+	modm/src/modm/io/iostream_printf.cpp
+)
+TARGET_INCLUDE_DIRECTORIES(lpsr-modm-io PUBLIC modm/src)
+TARGET_COMPILE_OPTIONS(lpsr-modm-io PRIVATE -w)
+
+ADD_HOST_TEST(iostream_float_test)
+TARGET_LINK_LIBRARIES(iostream_float_test lpsr-modm-io)
+
+# The threaded tests again under ThreadSanitizer, where the compiler has it
+INCLUDE(CheckCXXSourceCompiles)
+SET(CMAKE_REQUIRED_FLAGS -fsanitize=thread)
+CHECK_CXX_SOURCE_COMPILES("int main() { return 0; }" HAVE_THREAD_SANITIZER)
+UNSET(CMAKE_REQUIRED_FLAGS)
+IF(HAVE_THREAD_SANITIZER)
+	ADD_EXECUTABLE(spsc_queue_test_tsan src/tests/spsc_queue_test.cpp)
+	TARGET_COMPILE_OPTIONS(spsc_queue_test_tsan PRIVATE -fsanitize=thread -g)
+	TARGET_LINK_LIBRARIES(spsc_queue_test_tsan Threads::Threads -fsanitize=thread)
+	ADD_TEST(NAME spsc_queue_test_tsan COMMAND spsc_queue_test_tsan)
+	SET_TESTS_PROPERTIES(spsc_queue_test_tsan PROPERTIES ENVIRONMENT TSAN_OPTIONS=halt_on_error=1)
+ENDIF()
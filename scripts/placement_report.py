@@ -0,0 +1,58 @@
+# Reports what the firmware runs from SRAM and what from flash: the sizes of
+# its sections, the functions and tables in .fastcode and .fastdata, and the
+# hot ones that are in flash, which is all of them with -DFAST_RAM=OFF.
+# The firmware build runs it after linking.
+# Usage: python3 scripts/placement_report.py [--objdump arm-none-eabi-objdump] <firmware.elf>
+import subprocess
+import sys
+
+# Names of the functions and tables src/common/fast_memory.hpp and the linker script place in SRAM
+HOT = ["Dtw<", "frontend::", "HalfBandDecimator<", "arm_rfft_fast_f32", "arm_cfft_f32", "arm_radix8", "arm_bitreversal"]
+SECTIONS = [".fastcode", ".fastdata", ".text", ".rodata", ".data", ".bss"]
+
+args = sys.argv[1:]
+objdump = "arm-none-eabi-objdump"
+if len(args) == 3 and args[0] == "--objdump":
+	objdump = args[1]
+	args = args[2:]
+if len(args) != 1:
+	sys.exit("usage: placement_report.py [--objdump arm-none-eabi-objdump] <firmware.elf>")
+elf = args[0]
+
+def run(*command):
+	return subprocess.run(command, check=True, stdout=subprocess.PIPE, universal_newlines=True).stdout
+
+def memory(address):
+	return "SRAM" if 0x20000000 <= address < 0x40000000 else "flash"
+
+# Idx Name Size VMA LMA File-offset Alignment
+sizes = {}
+for line in run(objdump, "-h", elf).splitlines():
+	fields = line.split()
+	if len(fields) == 7 and fields[0].isdigit() and fields[1] in SECTIONS:
+		sizes[fields[1]] = (int(fields[2], 16), int(fields[3], 16))
+for name in SECTIONS:
+	if name in sizes:
+		size, address = sizes[name]
+		print(f"{name:10} {size:7} bytes in {memory(address)}")
+
+# Address, flags, section, then size and name after a tab
+fast = []
+slow = []
+for line in run(objdump, "-t", "-C", elf).splitlines():
+	left, tab, right = line.partition("\t")
+	fields = left.split()
+	if not tab or len(fields) < 3 or fields[-2] not in ("F", "O"):
+		continue
+	size, _, name = right.partition(" ")
+	symbol = (int(size, 16), fields[-1], name.strip())
+	if fields[-1] in (".fastcode", ".fastdata"):
+		fast.append(symbol)
+	elif memory(int(fields[0], 16)) == "flash" and any(hot in symbol[2] for hot in HOT):
+		slow.append(symbol)
+
+for title, symbols in (("in SRAM:", fast), ("hot, in flash:", slow)):
+	if symbols:
+		print(title)
+		for size, section, name in sorted(symbols, reverse=True):
+			print(f"  {size:6} {section:10} {name[:100]}")
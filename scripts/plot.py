@@ -23,7 +23,7 @@ p.setYRange(-20,20)
 curve = p.plot()                        # create an empty "plot" (a curve to plot)
 curve.setPos(0,0)                   # set x position in the graph to 0
 
-frequencyScale = np.linspace(0, 13000 / 2, num=256)
+frequencyScale = np.linspace(0, 9650 / 2, num=256)
 
 def get_data():
 	# line = ""
@@ -52,9 +52,10 @@ def update():
 			QtGui.QApplication.processEvents()
 		elif line.startswith(b"spec:"):
 			data = np.fromstring(line[5:].decode('ascii').strip(), dtype=float, sep=" ")
-			if len(data) == 256:
-				curve.setData(frequencyScale, data)
-				p.setXRange(0, 6500)
+			# 256 bins up to 4.8 kHz, or 128 up to 2.4 kHz with DECIMATE
+			if len(data) in (128, 256):
+				curve.setData(frequencyScale[:len(data)], data)
+				p.setXRange(0, 5000)
 				p.setYRange(0,500)
 				QtGui.QApplication.processEvents()
 		elif line.startswith(b"mfcc:"):
@@ -0,0 +1,34 @@
+# Uploads a template database (templates.bin from the build directory) to the board.
+# Usage: python3 scripts/upload_templates.py <templates.bin> [port]
+import serial
+import sys
+
+CHUNK_SIZE = 128 # TemplateUpload::chunkSize in src/app/template_upload.hpp
+
+database = open(sys.argv[1], "rb").read()
+port = sys.argv[2] if len(sys.argv) > 2 else "/dev/ttyACM0"
+ser = serial.Serial(port, 1000000, timeout=5)
+
+# Telemetry keeps running during the upload, skip everything that is not an answer
+def wait_for_answer():
+	while True:
+		line = ser.readline().decode("ascii", errors="replace").strip()
+		if line == "":
+			sys.exit("no answer from the board")
+		if line.startswith("msg:upload:"):
+			return line[len("msg:upload:"):].strip()
+		if line.startswith("msg:error:"):
+			sys.exit(line)
+
+ser.write(f"upload {len(database)}\n".encode("ascii"))
+# Erasing the flash sector takes about a second
+answer = wait_for_answer()
+if answer != "ready":
+	sys.exit(f"unexpected answer: {answer}")
+
+for offset in range(0, len(database), CHUNK_SIZE):
+	ser.write(database[offset:offset + CHUNK_SIZE])
+	answer = wait_for_answer()
+	print(f"\r{min(offset + CHUNK_SIZE, len(database))}/{len(database)} bytes", end="")
+print()
+print(answer)
@@ -0,0 +1,89 @@
+#pragma once
+#include <algorithm>
+#include <array>
+
+#include <gcem.hpp>
+
+#include <common/fast_memory.hpp>
+
+/**
+ * Halves the sample rate of a stream of blocks with a half-band FIR lowpass.
+ *
+ * The taps are a windowed sinc cut off at a quarter of the input rate, so
+ * every other one is zero and the rest are symmetric: an output sample costs
+ * (NumTaps + 1) / 4 multiplies. The Kaiser window trades the transition width
+ * against the stopband attenuation; the default 47 taps at 9.65 kHz pass up to
+ * 2.1 kHz within 0.4% and attenuate 2.7 kHz and above by 49 dB. The delay is
+ * (NumTaps - 1) / 2 input samples.
+ *
+ * The last NumTaps - 1 input samples are kept between blocks.
+ */
+template<int BlockSize, int NumTaps = 47>
+class HalfBandDecimator {
+	static_assert(BlockSize % 2 == 0);
+	static_assert(NumTaps % 4 == 3, "a half-band filter has 4k + 3 taps with nonzero ends");
+
+public:
+	static constexpr int outputSize = BlockSize / 2;
+	static constexpr int delay = (NumTaps - 1) / 2;
+
+	// Filters a block of BlockSize samples, converted to float by toFloat, and
+	// passes the outputSize output samples to store(index, sample)
+	template<typename Sample, typename ToFloat, typename Store>
+	LPSR_FASTCODE void process(const Sample* input, ToFloat toFloat, Store store) {
+		std::copy(history.end() - (NumTaps - 1), history.end(), history.begin());
+		std::transform(input, input + BlockSize, history.begin() + (NumTaps - 1), toFloat);
+
+		for (int i = 0; i < outputSize; i++) {
+			const float* center = history.data() + 2 * i + delay;
+			float sum = taps.center * center[0];
+			for (int j = 0; j < numPairs; j++) {
+				sum += taps.pairs[j] * (center[-(2 * j + 1)] + center[2 * j + 1]);
+			}
+			store(i, sum);
+		}
+	}
+
+private:
+	static constexpr int numPairs = (NumTaps + 1) / 4;
+
+	// The nonzero taps, pairs[j] for both offsets 2j + 1 from the center
+	struct Taps {
+		float center;
+		std::array<float, numPairs> pairs;
+
+		constexpr Taps() : center(), pairs() {
+			constexpr double pi = 3.14159265358979323846;
+			// 49 dB stopband
+			constexpr double beta = 4.4;
+			double sum = 0.5;
+			std::array<double, numPairs> weights = {};
+			for (int j = 0; j < numPairs; j++) {
+				const int offset = 2 * j + 1;
+				const double ratio = double(offset) / delay;
+				const double window = besselI0(beta * gcem::sqrt(1 - ratio * ratio)) / besselI0(beta);
+				weights[j] = gcem::sin(pi * offset / 2) / (pi * offset) * window;
+				sum += 2 * weights[j];
+			}
+			// Unity gain at DC
+			center = static_cast<float>(0.5 / sum);
+			for (int j = 0; j < numPairs; j++) {
+				pairs[j] = static_cast<float>(weights[j] / sum);
+			}
+		}
+
+		static constexpr double besselI0(double x) {
+			double term = 1;
+			double sum = 1;
+			for (int k = 1; k < 32; k++) {
+				term *= (x / (2 * k)) * (x / (2 * k));
+				sum += term;
+			}
+			return sum;
+		}
+	};
+
+	LPSR_FASTDATA static constexpr Taps taps{};
+
+	std::array<float, NumTaps - 1 + BlockSize> history = {};
+};
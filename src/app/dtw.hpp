@@ -1,5 +1,10 @@
 #pragma once
 #include <algorithm>
+#include <array>
+#include <cstdint>
+#include <utility>
+
+#include <common/fast_memory.hpp>
 
 namespace dtw {
 	template <typename SequenceType>
@@ -10,28 +15,31 @@ template <int MaxSize, typename SequenceType>
 class Dtw {
 	using CostType = uint32_t;
 public:
-	uint32_t compare(const SequenceType* sequenceA, int lengthA, const SequenceType* sequenceB, int lengthB) {
-		// Evaluate edge of cost matrix
-		for (int iA = 0; iA < lengthA; iA++) {
-			costMatrix[iA][0] = costMatrix[iA - 1][0] + dtw::distanceMetric(sequenceA[iA], sequenceB[0]);
-		}
+	LPSR_FASTCODE uint32_t compare(const SequenceType* sequenceA, int lengthA, const SequenceType* sequenceB, int lengthB) {
+		// Each row of the cost matrix only depends on the row before, so two
+		// rows take turns instead of keeping the whole matrix
+		CostType* previous = rows[0].data();
+		CostType* current = rows[1].data();
+		// Evaluate first row of cost matrix
+		previous[0] = dtw::distanceMetric(sequenceA[0], sequenceB[0]);
 		for (int iB = 1; iB < lengthB; iB++) {
-			costMatrix[0][iB] = costMatrix[0][iB - 1] + dtw::distanceMetric(sequenceA[0], sequenceB[iB]);
+			previous[iB] = previous[iB - 1] + dtw::distanceMetric(sequenceA[0], sequenceB[iB]);
 		}
-		// Fill in rest of cost matrix
-		for (int iA = 0; iA < lengthA; iA++) {
-			for (int iB = 0; iB < lengthB; iB++) {
-				CostType below = costMatrix[iA - 1][iB];
-				CostType left = costMatrix[iA][iB - 1];
-				CostType belowLeft = costMatrix[iA - 1][iB - 1];
+		// Fill in the rest row by row
+		for (int iA = 1; iA < lengthA; iA++) {
+			current[0] = previous[0] + dtw::distanceMetric(sequenceA[iA], sequenceB[0]);
+			for (int iB = 1; iB < lengthB; iB++) {
+				CostType below = previous[iB];
+				CostType left = current[iB - 1];
+				CostType belowLeft = previous[iB - 1];
 				CostType cheapestNeighbor = std::min(belowLeft, std::min(below, left));
-				costMatrix[iA][iB] = cheapestNeighbor + dtw::distanceMetric(sequenceA[iA], sequenceB[iB]);
+				current[iB] = cheapestNeighbor + dtw::distanceMetric(sequenceA[iA], sequenceB[iB]);
 			}
+			std::swap(previous, current);
 		}
-		return costMatrix[lengthA - 1][lengthB - 1] / (lengthA + lengthB);
+		return previous[lengthB - 1] / (lengthA + lengthB);
 	}
 private:
-	std::array<std::array<uint32_t, MaxSize>, MaxSize> costMatrix;
+	std::array<std::array<CostType, MaxSize>, 2> rows;
 
 };
-
@@ -0,0 +1,78 @@
+#pragma once
+#include <cstdint>
+
+/**
+ * Sleeping when there is no work, and accounting of the time the core is
+ * awake versus asleep.
+ *
+ * The main loop calls idle() once it ran out of work. The wait primitive is a
+ * policy, so the same logic runs on the host with a simulated clock:
+ *
+ *     struct Sleep {
+ *         void lock();      // mask interrupts, pending ones still end wait()
+ *         void unlock();    // unmask, pending handlers run now
+ *         void wait();      // sleep until an interrupt is pending
+ *         uint32_t now();   // any free-running tick counter
+ *     };
+ *
+ * Interrupts are masked from the last check for work until after the sleep.
+ * An interrupt arriving in between ends wait() at once instead of being slept
+ * through, and the wake-up time is taken before its handler runs, so handlers
+ * count as active time.
+ */
+namespace duty {
+
+	struct Counters {
+		uint32_t activeTicks = 0;
+		uint32_t sleepTicks = 0;
+		uint32_t wakeups = 0;
+
+		// Share of the time awake in per mille
+		uint32_t activePerMille() const {
+			const uint64_t total = uint64_t(activeTicks) + sleepTicks;
+			return (total > 0) ? uint32_t(uint64_t(activeTicks) * 1000 / total) : 0;
+		}
+	};
+
+	template<typename Sleep>
+	class Meter {
+	public:
+		explicit Meter(Sleep& sleep) : sleep(sleep), lastWake(sleep.now()) {}
+
+		// Sleeps unless hasWork() is true, checked with interrupts masked.
+		// Returns whether it slept.
+		template<typename HasWork>
+		bool idle(HasWork hasWork) {
+			sleep.lock();
+			if (hasWork()) {
+				sleep.unlock();
+				return false;
+			}
+			const uint32_t sleepStart = sleep.now();
+			sleep.wait();
+			const uint32_t wake = sleep.now();
+			sleep.unlock();
+
+			periodCounters.activeTicks += sleepStart - lastWake;
+			periodCounters.sleepTicks += wake - sleepStart;
+			periodCounters.wakeups += 1;
+			lastWake = wake;
+			return true;
+		}
+
+		// Counters since the last call, the time since the last wake-up counts as active
+		Counters takePeriod() {
+			const uint32_t now = sleep.now();
+			Counters counters = periodCounters;
+			counters.activeTicks += now - lastWake;
+			lastWake = now;
+			periodCounters = Counters();
+			return counters;
+		}
+
+	private:
+		Sleep& sleep;
+		uint32_t lastWake;
+		Counters periodCounters;
+	};
+}
@@ -0,0 +1,246 @@
+#pragma once
+#include <algorithm>
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+
+/**
+ * Log of templates enrolled on the device, kept in two flash banks.
+ *
+ * New templates are appended to the active bank. When it is full, the live
+ * records are copied to the other bank, which then becomes the active one,
+ * so both banks are erased equally often. Forgetting a template only marks
+ * its record, the space is reclaimed by the next compaction. A RAM index of
+ * the live records is rebuilt by mount(), the frames are read from flash in
+ * place.
+ *
+ * Every flash word is programmed at most once between erases. An append that
+ * was interrupted leaves an uncommitted record that is skipped, an interrupted
+ * compaction leaves the old bank intact, since the new bank's header is
+ * written last.
+ *
+ * Storage must provide data(), size(), erase() and program(offset, word)
+ * like flash::Region (host: FlashFile::Region).
+ */
+namespace enrollment {
+
+	constexpr uint32_t bankMagic = 0x4b4e4245; // "EBNK"
+	constexpr uint32_t committedMarker = 0x600d600d;
+	constexpr uint32_t erasedWord = 0xffffffff;
+	constexpr int maxTextLength = 15;
+
+	struct BankHeader {
+		uint32_t magic;
+		// Incremented by every compaction, the bank with the higher one is active
+		uint32_t generation;
+	};
+
+	struct RecordHeader {
+		// Size of the record including the header, erasedWord marks the end of the log
+		uint32_t length;
+		uint32_t numFrames;
+		char text[maxTextLength + 1];
+		// committedMarker once all frames are written
+		uint32_t committed;
+		// erasedWord while the record is live, 0 once it was forgotten
+		uint32_t deleted;
+	};
+
+	enum class Error : uint8_t {
+		None,
+		Full,
+		BadTemplate,
+		FlashError,
+	};
+
+	constexpr const char* errorNames[] = { "none", "full", "bad template", "flash error" };
+
+	inline const char* errorName(Error error) {
+		return errorNames[static_cast<int>(error)];
+	}
+
+	template<typename Storage, int Dim, int MaxRecords>
+	class Log {
+	public:
+		using FeatureVector = std::array<float, Dim>;
+
+		Log(Storage& bankA, Storage& bankB) : banks{ &bankA, &bankB } {}
+
+		// Finds the active bank and indexes its records, formats the banks if neither is valid
+		bool mount() {
+			const BankHeader* headerA = bankHeader(0);
+			const BankHeader* headerB = bankHeader(1);
+			bool validA = headerA->magic == bankMagic;
+			bool validB = headerB->magic == bankMagic;
+			if (!validA && !validB) {
+				return clear();
+			}
+			if (validA && validB) {
+				// A compaction was interrupted after writing the new bank
+				active = (headerB->generation > headerA->generation) ? 1 : 0;
+				if (!banks[1 - active]->erase()) return false;
+			}
+			else {
+				active = validA ? 0 : 1;
+			}
+			scan();
+			return true;
+		}
+
+		// Erases both banks, forgetting all enrolled templates
+		bool clear() {
+			count = 0;
+			if (!banks[0]->erase() || !banks[1]->erase()) return false;
+			active = 0;
+			writeOffset = sizeof(BankHeader);
+			return writeBankHeader(0, 1);
+		}
+
+		Error append(const char* text, const FeatureVector* frames, int numFrames) {
+			if (numFrames <= 0 || std::strlen(text) > maxTextLength) return Error::BadTemplate;
+			if (count == MaxRecords) return Error::Full;
+			const uint32_t length = sizeof(RecordHeader) + numFrames * sizeof(FeatureVector);
+			if (writeOffset + length > banks[active]->size()) {
+				if (!compact()) return Error::FlashError;
+				if (writeOffset + length > banks[active]->size()) return Error::Full;
+			}
+
+			RecordHeader header;
+			std::memset(&header, 0, sizeof(header));
+			header.length = length;
+			header.numFrames = numFrames;
+			std::strncpy(header.text, text, maxTextLength);
+			header.committed = erasedWord;
+			header.deleted = erasedWord;
+
+			Storage& bank = *banks[active];
+			const uint32_t offset = writeOffset;
+			// Reserve the space first, so an interrupted append is skipped at the next mount
+			writeOffset += length;
+			bool ok = programWords(bank, offset, &header, offsetof(RecordHeader, committed))
+				&& programWords(bank, offset + sizeof(RecordHeader), frames, numFrames * sizeof(FeatureVector))
+				&& bank.program(offset + offsetof(RecordHeader, committed), committedMarker);
+			if (!ok) return Error::FlashError;
+
+			index[count++] = record(offset);
+			return Error::None;
+		}
+
+		// Forgets all templates with this text, returns how many there were, or
+		// -1 if marking one failed. That one and the ones after it stay live,
+		// in RAM as in flash.
+		int forget(const char* text) {
+			int removed = 0;
+			for (int i = 0; i < count;) {
+				if (std::strcmp(index[i]->text, text) == 0) {
+					uint32_t offset = reinterpret_cast<const uint8_t*>(index[i]) - banks[active]->data();
+					if (!banks[active]->program(offset + offsetof(RecordHeader, deleted), 0)) return -1;
+					std::copy(index.begin() + i + 1, index.begin() + count, index.begin() + i);
+					count -= 1;
+					removed += 1;
+				}
+				else {
+					i++;
+				}
+			}
+			return removed;
+		}
+
+		int size() const {
+			return count;
+		}
+
+		const char* text(int idx) const {
+			return index[idx]->text;
+		}
+
+		int numFrames(int idx) const {
+			return index[idx]->numFrames;
+		}
+
+		const FeatureVector* frames(int idx) const {
+			return reinterpret_cast<const FeatureVector*>(index[idx] + 1);
+		}
+
+		uint32_t bytesFree() const {
+			return banks[active]->size() - writeOffset;
+		}
+
+		uint32_t generation() const {
+			return bankHeader(active)->generation;
+		}
+
+	private:
+		std::array<Storage*, 2> banks;
+		std::array<const RecordHeader*, MaxRecords> index;
+		int count = 0;
+		int active = 0;
+		uint32_t writeOffset = sizeof(BankHeader);
+
+		const BankHeader* bankHeader(int bank) const {
+			return reinterpret_cast<const BankHeader*>(banks[bank]->data());
+		}
+
+		const RecordHeader* record(uint32_t offset) const {
+			return reinterpret_cast<const RecordHeader*>(banks[active]->data() + offset);
+		}
+
+		void scan() {
+			count = 0;
+			const uint32_t bankSize = banks[active]->size();
+			uint32_t offset = sizeof(BankHeader);
+			while (offset + sizeof(RecordHeader) <= bankSize) {
+				const RecordHeader* header = record(offset);
+				if (header->length == erasedWord) break;
+				if (header->length < sizeof(RecordHeader) || header->length % 4 != 0 || header->length > bankSize - offset) {
+					// Corrupted, treat the bank as full so the next append compacts it
+					offset = bankSize;
+					break;
+				}
+				bool valid = header->committed == committedMarker
+					&& header->deleted == erasedWord
+					&& header->length == sizeof(RecordHeader) + header->numFrames * sizeof(FeatureVector)
+					&& header->text[maxTextLength] == '\0';
+				if (valid && count < MaxRecords) {
+					index[count++] = header;
+				}
+				offset += header->length;
+			}
+			writeOffset = offset;
+		}
+
+		// Copies the live records to the other bank and makes it the active one
+		bool compact() {
+			const int target = 1 - active;
+			Storage& bank = *banks[target];
+			if (!bank.erase()) return false;
+			uint32_t offset = sizeof(BankHeader);
+			for (int i = 0; i < count; i++) {
+				if (!programWords(bank, offset, index[i], index[i]->length)) return false;
+				offset += index[i]->length;
+			}
+			if (!writeBankHeader(target, generation() + 1)) return false;
+			const int old = active;
+			active = target;
+			scan();
+			return banks[old]->erase();
+		}
+
+		bool writeBankHeader(int bank, uint32_t generation) {
+			// The magic is written last, it makes the bank valid
+			return banks[bank]->program(offsetof(BankHeader, generation), generation)
+				&& banks[bank]->program(offsetof(BankHeader, magic), bankMagic);
+		}
+
+		static bool programWords(Storage& bank, uint32_t offset, const void* data, uint32_t length) {
+			const uint8_t* bytes = static_cast<const uint8_t*>(data);
+			for (uint32_t i = 0; i < length; i += 4) {
+				uint32_t word;
+				std::memcpy(&word, bytes + i, sizeof(word));
+				if (!bank.program(offset + i, word)) return false;
+			}
+			return true;
+		}
+	};
+}
@@ -0,0 +1,59 @@
+#pragma once
+#include <array>
+#include <cmath>
+#include <cstddef>
+
+#include <common/fast_math.hpp>
+
+#include "parameters.hpp"
+#include "dtw.hpp"
+
+using FeatureVector = std::array<float, featureVectorDim>;
+
+// We must specify a distance metric for each type used with the DTW algorithm
+template<>
+inline uint32_t dtw::distanceMetric(const FeatureVector& a, const FeatureVector& b) {
+	float magnitudeSquared = 0;
+	for (size_t i = 0; i < std::tuple_size<FeatureVector>::value; i++) {
+		magnitudeSquared += (b[i] - a[i]) * (b[i] - a[i]);
+	}
+	return std::sqrt(magnitudeSquared) * 65536.0;
+}
+
+// Rescales feature coefficients with the given squared magnitude to length ln(magnitude + 1)
+template<size_t Dim>
+void scaleFeatureVector(std::array<float, Dim>& featureVector, float magnitudeSquared) {
+	float featureVectorScaling = fastmath::sqrt(magnitudeSquared);
+	featureVectorScaling = fastmath::log<logApproximationDegree>(featureVectorScaling + 1.0f) / featureVectorScaling;
+	for (float& coefficient : featureVector) {
+		coefficient *= featureVectorScaling;
+	}
+}
+
+// Keep only certain terms from the DCT, and rescale them to length ln(originalMagnitude + 1)
+template<size_t NumCoefficients>
+void computeFeatureVector(const std::array<float, NumCoefficients>& melCepstrum, FeatureVector& featureVector) {
+	static_assert(featureVectorLastCoefficient <= NumCoefficients);
+	float magnitudeSquared = 0.0;
+	for (int i = featureVectorFirstCoefficient; i < featureVectorLastCoefficient; i++) {
+		magnitudeSquared += melCepstrum[i] * melCepstrum[i];
+		featureVector[i - featureVectorFirstCoefficient] = melCepstrum[i];
+	}
+	scaleFeatureVector(featureVector, magnitudeSquared);
+}
+
+// The feature vector straight from the log mel spectrum, with a DCT table of
+// just the feature coefficients: sums their squares for the scaling as they
+// are computed. Same result as computeFeatureVector() on the full cepstrum.
+template<typename FeatureDctTable, size_t NumFilters>
+void computeFeatureVector(const FeatureDctTable& featureDct, const std::array<float, NumFilters>& melPower,
+		std::array<float, FeatureDctTable::numCoefficients>& featureVector) {
+	constexpr int first = FeatureDctTable::firstCoefficient;
+	float magnitudeSquared = 0.0;
+	for (int i = first; i < FeatureDctTable::lastCoefficient; i++) {
+		const float coefficient = featureDct.evaluate(melPower, i);
+		magnitudeSquared += coefficient * coefficient;
+		featureVector[i - first] = coefficient;
+	}
+	scaleFeatureVector(featureVector, magnitudeSquared);
+}
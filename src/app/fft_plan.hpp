@@ -0,0 +1,121 @@
+#pragma once
+#include <array>
+#include <cstdint>
+
+#include <gcem.hpp>
+
+#include "arm_math.h"
+
+#include <common/utils.hpp>
+
+/**
+ * The tables of CMSIS-DSP's real FFT for one size, computed at compile time.
+ *
+ * arm_rfft_fast_init_f32 picks them from arm_common_tables.c at run time and,
+ * as it switches over all sizes, links in the tables of every size. A
+ * RealPlan<N> holds only those of an N point real FFT: the twiddles and bit
+ * reversal swaps of the N / 2 point complex FFT, and the twiddles that split
+ * its output into the real FFT's. settings() points an instance for
+ * arm_rfft_fast_f32 at them, so there is nothing to look up or compute at
+ * run time. arm_rfft_fast_f32 writes to its instance, so each user keeps its
+ * own copy, the tables are shared.
+ *
+ * kernel_bench checks that the output is bit for bit that of CMSIS-DSP's own
+ * tables.
+ */
+namespace fft {
+
+	// arm_cfft_f32 runs a radix 2 or 4 stage when n is not a power of 8, then
+	// radix 8 stages. Its bit reversal moves index digitReversed(i, n) to i:
+	// i's digits reversed, the radix 2 or 4 digit lowest in i.
+	constexpr int digitReversed(int i, int n) {
+		int firstRadix = n;
+		while (firstRadix >= 8) {
+			firstRadix /= 8;
+		}
+		int result = i % firstRadix;
+		i /= firstRadix;
+		for (int m = n / firstRadix; m > 1; m /= 8) {
+			result = result * 8 + i % 8;
+			i /= 8;
+		}
+		return result;
+	}
+
+	// Whether i is the smallest index of its cycle of the permutation
+	constexpr bool startsCycle(int i, int n) {
+		int j = digitReversed(i, n);
+		while (j > i) {
+			j = digitReversed(j, n);
+		}
+		return j == i;
+	}
+
+	// A cycle of k indices takes k - 1 swaps, as many as CMSIS-DSP's tables have
+	constexpr int numBitReversalSwaps(int n) {
+		int swaps = n;
+		for (int i = 0; i < n; i++) {
+			swaps -= startsCycle(i, n);
+		}
+		return swaps;
+	}
+
+	// arm_common_tables.c has its twiddles to nine decimals. Rounded the same,
+	// the plan's give bit for bit the output of CMSIS-DSP's tables.
+	constexpr float32_t printedTwiddle(double x) {
+		return static_cast<float32_t>(gcem::round(x * 1e9) / 1e9);
+	}
+
+	template<int N>
+	class RealPlan {
+		static_assert(isPowerOf2(N) && N >= 32 && N <= 4096, "the sizes of arm_rfft_fast_f32");
+
+		static constexpr int complexSize = N / 2;
+
+	public:
+		static constexpr int bitReversalLength = 2 * numBitReversalSwaps(complexSize);
+
+		constexpr RealPlan() : twiddles(), bitReversal(), splitTwiddles() {
+			// cos and sin interleaved, of 2 pi k / complexSize for the complex
+			// FFT and as sin and cos of 2 pi k / N for the split
+			for (int k = 0; k < complexSize; k++) {
+				twiddles[2 * k] = printedTwiddle(gcem::cos(2 * pi * k / complexSize));
+				twiddles[2 * k + 1] = printedTwiddle(gcem::sin(2 * pi * k / complexSize));
+			}
+			for (int k = 0; k < N / 2; k++) {
+				splitTwiddles[2 * k] = printedTwiddle(gcem::sin(2 * pi * k / N));
+				splitTwiddles[2 * k + 1] = printedTwiddle(gcem::cos(2 * pi * k / N));
+			}
+
+			// Each cycle as swaps of its neighbours, in byte offsets of the
+			// complex values as arm_bitreversal_32 reads them
+			int n = 0;
+			for (int i = 0; i < complexSize; i++) {
+				if (!startsCycle(i, complexSize)) {
+					continue;
+				}
+				for (int j = i; digitReversed(j, complexSize) != i; j = digitReversed(j, complexSize)) {
+					bitReversal[n++] = static_cast<uint16_t>(j * 2 * sizeof(float32_t));
+					bitReversal[n++] = static_cast<uint16_t>(digitReversed(j, complexSize) * 2 * sizeof(float32_t));
+				}
+			}
+		}
+
+		// arm_rfft_fast_f32 takes its instance non-const and writes its fftLen
+		// again, but only reads the tables
+		constexpr arm_rfft_fast_instance_f32 settings() const {
+			return {
+				{ complexSize, twiddles.data(), bitReversal.data(), bitReversalLength },
+				N,
+				const_cast<float32_t*>(splitTwiddles.data()),
+			};
+		}
+
+	private:
+		std::array<float32_t, 2 * complexSize> twiddles;
+		std::array<uint16_t, bitReversalLength> bitReversal;
+		std::array<float32_t, N> splitTwiddles;
+
+		static constexpr double pi = 3.14159265358979323846;
+	};
+}
@@ -0,0 +1,108 @@
+#pragma once
+#include <array>
+#include <cstdint>
+#include <initializer_list>
+
+/**
+ * Real-time budget accounting for the frame pipeline.
+ *
+ * Every block of samples must be processed before the next one arrives, so a
+ * frame's deadline is budgetTicks after its block became ready. Time is
+ * measured in ticks of any free-running counter (cycleCounter on the target,
+ * a simulated clock on the host), differences are taken modulo 2^32.
+ *
+ * A frame is split into stages. When a frame misses its deadline, the overrun
+ * is attributed to the stage that was running when the deadline passed.
+ *
+ * The stages are those of the feature interrupt. The DTW and the printing run
+ * in thread mode from the frame queue and have no deadline of their own, when
+ * they fall behind frames are dropped from the queue instead.
+ */
+namespace budget {
+
+	enum class Stage : uint8_t {
+		Wait,         // Block ready until processing started
+		Preprocess,   // Copy, normalization, word segmentation
+		Features,     // FFT to feature vector
+	};
+
+	constexpr int numStages = 3;
+	constexpr const char* stageNames[numStages] = { "wait", "pre", "feat" };
+
+	struct Counters {
+		uint32_t frames = 0;
+		uint32_t deadlineMisses = 0;
+		uint32_t lostBlocks = 0;
+		// Smallest remaining time before the deadline, negative if it was missed
+		int32_t worstSlack = INT32_MAX;
+		// Deadline misses by the stage that was running when the deadline passed
+		std::array<uint32_t, numStages> overruns = {};
+	};
+
+	class FrameBudget {
+	public:
+		explicit FrameBudget(uint32_t budgetTicks) : budgetTicks(budgetTicks) {}
+
+		// readyTime is when the block became available, startTime when its processing began
+		void beginFrame(uint32_t readyTime, uint32_t startTime) {
+			frameReadyTime = readyTime;
+			lastStageEnd = readyTime;
+			deadlinePassed = false;
+			endStage(Stage::Wait, startTime);
+		}
+
+		void endStage(Stage stage, uint32_t now) {
+			stageTicks[static_cast<int>(stage)] = now - lastStageEnd;
+			lastStageEnd = now;
+			if (!deadlinePassed && now - frameReadyTime > budgetTicks) {
+				deadlinePassed = true;
+				overrunStage = stage;
+			}
+		}
+
+		void endFrame(uint32_t now) {
+			const int32_t slack = static_cast<int32_t>(budgetTicks - (now - frameReadyTime));
+			for (Counters* counters : { &periodCounters, &totalCounters }) {
+				counters->frames += 1;
+				counters->worstSlack = (slack < counters->worstSlack) ? slack : counters->worstSlack;
+				if (deadlinePassed) {
+					counters->deadlineMisses += 1;
+					counters->overruns[static_cast<int>(overrunStage)] += 1;
+				}
+			}
+		}
+
+		void addLostBlocks(uint32_t count) {
+			periodCounters.lostBlocks += count;
+			totalCounters.lostBlocks += count;
+		}
+
+		// Ticks spent in a stage in the last frame it ran in
+		uint32_t lastStageTicks(Stage stage) const {
+			return stageTicks[static_cast<int>(stage)];
+		}
+
+		// Counters since the last resetPeriod()
+		const Counters& period() const { return periodCounters; }
+		// Counters since startup
+		const Counters& total() const { return totalCounters; }
+
+		void resetPeriod() {
+			periodCounters = Counters();
+		}
+
+		uint32_t budget() const {
+			return budgetTicks;
+		}
+
+	private:
+		uint32_t budgetTicks;
+		uint32_t frameReadyTime = 0;
+		uint32_t lastStageEnd = 0;
+		bool deadlinePassed = false;
+		Stage overrunStage = Stage::Wait;
+		std::array<uint32_t, numStages> stageTicks = {};
+		Counters periodCounters;
+		Counters totalCounters;
+	};
+}
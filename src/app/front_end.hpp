@@ -0,0 +1,151 @@
+#pragma once
+#include <algorithm>
+#include <array>
+#include <cstdint>
+#include <type_traits>
+
+#include "arm_math.h"
+
+#include <common/arena.hpp>
+#include <common/profiler.hpp>
+
+#include "parameters.hpp"
+#include "decimator.hpp"
+#include "front_end_stages.hpp"
+
+/**
+ * The feature extraction front end, from blocks of ADC samples to the mel
+ * cepstrum. The firmware and the host tools run this same code, the host
+ * links the CMSIS-DSP FFT built for x86 (see scripts/host.cmake).
+ *
+ * The sizes, tables and FFT come from the Config, a PipelineConfig (see
+ * pipeline_config.hpp); FrontEnd is the one the firmware is built with.
+ *
+ * Samples are in ADC counts (12 bit, 0 to 4095). Each block of windowStride
+ * samples is shifted into a window of windowSize samples.
+ *
+ * With a decimation of 2 the blocks are lowpass filtered and decimated to
+ * fftStride samples first, and the window, FFT and filterbank are at half
+ * the sample rate with half the size. The bins keep their width, so the
+ * filterbank is the same, and the filterbank ends below the lower Nyquist
+ * frequency, so all it loses is the band above it. The decimated samples are
+ * rounded back to ADC counts, which adds no more noise than the ADC's own
+ * quantization.
+ *
+ * The steps after the window are the stages in front_end_stages.hpp. The
+ * buffers between them only live within a frame and share memory by the
+ * FramePlan (see common/arena.hpp): the log mel spectrum and the cepstrum
+ * reuse the normalized window, which the FFT is done with. So the cepstrum
+ * and the spectrum can only be read until the next block is added.
+ */
+template<typename Config>
+class BasicFrontEnd {
+	static constexpr int decimation = Config::decimation;
+	static constexpr int numFilters = Config::numMelFilters;
+
+public:
+	static constexpr int fftSize = Config::fftSize;
+	static constexpr int fftStride = Config::fftStride;
+	static constexpr int fftSampleRate = Config::fftSampleRate;
+
+	using MelFilterbank = typename frontend::LogMelPower<Config>::MelFilterbank;
+	using CepstrumDctTable = typename frontend::Cepstrum<Config>::DctTable;
+	using FeatureDctTable = typename frontend::Features<Config>::DctTable;
+	using FeatureVector = typename frontend::Features<Config>::Output;
+
+	// The buffers of a frame, live from the step that writes them to the last
+	// that reads them: 0 addBlock(), 1 the FFT, 2 the filterbank, 3 the DCT,
+	// 4 cepstrum() and computeSpectrum()
+	enum FrameBuffer : size_t { NormalizedBuffer, FftBuffer, MelPowerBuffer, CepstrumBuffer };
+	using FramePlan = arena::Plan<
+		arena::Buffer<frontend::Samples<Config>, 0, 1>,
+		arena::Buffer<frontend::Samples<Config>, 1, 4>,
+		arena::Buffer<frontend::MelSpectrum<Config>, 2, 3>,
+		arena::Buffer<frontend::MelSpectrum<Config>, 3, 4>>;
+
+	// Shifts in a block of windowStride samples, normalizes and windows the
+	// samples, and returns their root-mean-squared amplitude
+	float addBlock(const uint16_t* newSamples) {
+		return addBlock(newSamples, [](uint16_t sample) { return sample; });
+	}
+
+	// Like addBlock(), converting samples of another format to ADC counts
+	// while they are shifted in, so they need no intermediate buffer
+	template<typename Sample, typename ToAdc>
+	float addBlock(const Sample* newSamples, ToAdc toAdc) {
+		{
+			PROFILE_ZONE("copy");
+			// Shift old samples and copy new samples to buffer
+			std::copy(rawSamples.begin() + fftStride, rawSamples.end(), rawSamples.begin());
+			if constexpr (decimation == 1) {
+				std::transform(newSamples, newSamples + Config::windowStride, rawSamples.end() - Config::windowStride, toAdc);
+			}
+		}
+		if constexpr (decimation != 1) {
+			PROFILE_ZONE("decim");
+			decimator.process(newSamples, [&toAdc](Sample sample) { return float(toAdc(sample)); }, [this](int i, float sample) {
+				rawSamples[fftSize - fftStride + i] = static_cast<uint16_t>(std::max(sample + 0.5f, 0.0f));
+			});
+		}
+
+		normalize.process(rawSamples, frame.template begin<NormalizedBuffer>());
+		return normalize.amplitude();
+	}
+
+	// Computes the mel cepstrum of the current window, all numMelFilters coefficients
+	void computeCepstrum() {
+		computeMelPower();
+		cepstrumStage.process(frame.template get<MelPowerBuffer>(), frame.template begin<CepstrumBuffer>());
+	}
+
+	// Computes the feature vector of the current window without the rest of
+	// the cepstrum, only the DCT rows it needs
+	void computeFeatureVector(FeatureVector& featureVector) {
+		computeMelPower();
+		featureStage.process(frame.template get<MelPowerBuffer>(), featureVector);
+	}
+
+	float amplitude() const {
+		return normalize.amplitude();
+	}
+
+	// The window, at fftSampleRate
+	const std::array<uint16_t, fftSize>& samples() const {
+		return rawSamples;
+	}
+
+	// The power spectrum of the window computeCepstrum() or computeFeatureVector()
+	// last ran on, for the telemetry
+	void computeSpectrum(std::array<float, fftSize / 2>& spectrumPower) const {
+		// CMSIS-DSP does not take const input
+		const auto& fftSamples = frame.template get<FftBuffer>();
+		arm_cmplx_mag_squared_f32(const_cast<float*>(fftSamples.data()), spectrumPower.data(), fftSize / 2);
+	}
+
+	// The cepstrum of the window computeCepstrum() last ran on
+	const std::array<float, numFilters>& cepstrum() const {
+		return frame.template get<CepstrumBuffer>();
+	}
+
+private:
+	// Computes the log mel spectrum of the current window
+	void computeMelPower() {
+		fft.process(frame.template get<NormalizedBuffer>(), frame.template begin<FftBuffer>());
+		logMelPower.process(frame.template get<FftBuffer>(), frame.template begin<MelPowerBuffer>());
+	}
+
+	// Stages
+	frontend::Normalize<Config> normalize;
+	frontend::RealFft<Config> fft;
+	frontend::LogMelPower<Config> logMelPower;
+	frontend::Cepstrum<Config> cepstrumStage;
+	frontend::Features<Config> featureStage;
+
+	// Buffers
+	struct NoDecimator {};
+	std::conditional_t<decimation == 1, NoDecimator, HalfBandDecimator<Config::windowStride>> decimator;
+	std::array<uint16_t, fftSize> rawSamples = {};
+	arena::Arena<FramePlan> frame;
+};
+
+using FrontEnd = BasicFrontEnd<Pipeline>;
@@ -0,0 +1,192 @@
+#pragma once
+#include <array>
+#include <cmath>
+#include <cstdint>
+#include <numeric>
+#include <type_traits>
+
+#include "arm_math.h"
+
+#include <common/fast_math.hpp>
+#include <common/fast_memory.hpp>
+#include <common/profiler.hpp>
+
+#include "stage.hpp"
+#include "fft_plan.hpp"
+#include "transform.hpp"
+#include "mfcc.hpp"
+#include "feature_vector.hpp"
+
+/**
+ * The steps of the front end as stages (see stage.hpp), each sized by a
+ * PipelineConfig. BasicFrontEnd runs them; the host tools can run, time or
+ * recombine each one on its own.
+ *
+ * The stages and their tables run from SRAM (see common/fast_memory.hpp),
+ * RealFft's CMSIS-DSP code is placed there by the linker script.
+ */
+namespace frontend {
+
+	template<typename Config>
+	using Window = std::array<uint16_t, Config::fftSize>;
+
+	template<typename Config>
+	using Samples = std::array<float, Config::fftSize>;
+
+	template<typename Config>
+	using MelSpectrum = std::array<float, Config::numMelFilters>;
+
+	// Removes the mean of a window of ADC counts, scales it approximately to
+	// [-1, 1] and applies the Hann window. Also takes the root-mean-squared
+	// amplitude for the segmentation.
+	template<typename Config>
+	class Normalize {
+		static constexpr int size = Config::fftSize;
+		static constexpr int decimation = Config::decimation;
+
+	public:
+		using Input = Window<Config>;
+		using Output = Samples<Config>;
+
+		LPSR_FASTCODE void process(const Input& window, Output& samples) {
+			float sampleMean;
+			{
+				PROFILE_ZONE("avg");
+				// Take the mean of the samples so it can be subtracted during normalization
+				auto sampleSum = std::accumulate(window.begin(), window.end(), uint32_t(0));
+				// Make sure the sum was to a uint32_t to prevent overflow
+				static_assert(std::is_same<decltype(sampleSum), uint32_t>::value);
+				sampleMean = static_cast<float>(sampleSum) / size;
+			}
+
+			PROFILE_ZONE("normal");
+			// At the same time, take the root-mean-squared amplitude
+			// The FFT's output scales with its size, a shorter window is
+			// amplified by the decimation to keep the spectrum's level
+			float power = 0;
+			for (int i = 0; i < size; i++) {
+				float normalizedSample = windowingLut[i] * (window[i] - sampleMean) / (512.0 / decimation);
+				power += normalizedSample * normalizedSample;
+				samples[i] = normalizedSample;
+			}
+			rmsAmplitude = std::sqrt(power / size) / decimation;
+		}
+
+		// Of the last window
+		float amplitude() const {
+			return rmsAmplitude;
+		}
+
+	private:
+		LPSR_FASTDATA static constexpr HannWindow<size> windowingLut{};
+
+		float rmsAmplitude = 0;
+	};
+
+	// CMSIS-DSP's real FFT, in its packed format, with tables of only its size
+	// computed at compile time (see fft_plan.hpp). Uses its input as scratch.
+	template<typename Config>
+	class RealFft {
+	public:
+		using Input = Samples<Config>;
+		using Output = Samples<Config>;
+
+		void process(Input& samples, Output& spectrum) {
+			PROFILE_ZONE("fft");
+			arm_rfft_fast_f32(&fftSettings, samples.data(), spectrum.data(), 0);
+		}
+
+	private:
+		LPSR_FASTDATA static constexpr fft::RealPlan<Config::fftSize> plan{};
+		// Per object, arm_rfft_fast_f32 writes to it on every call
+		arm_rfft_fast_instance_f32 fftSettings = plan.settings();
+	};
+
+	// The log2 of the power of the bins in the mel filterbank's band run
+	// through the filterbank, the rest of the spectrum is never computed. The
+	// filterbank runs as a loop, LPSR_UNROLLED_MEL unrolls it into
+	// straight-line code. With LPSR_MEL_REFERENCE the unfused power spectrum
+	// and filterbank it replaced run too, in their own profiler zone, so the
+	// prof stream compares the two on the board.
+	template<typename Config>
+	class LogMelPower {
+	public:
+		using MelFilterbank = mfcc::MelFilterLut<Config::numMelFilters, Config::melLowFrequency, Config::melHighFrequency,
+			Config::fftSize, Config::fftFilterbankSampleRate>;
+
+		using Input = Samples<Config>;
+		using Output = MelSpectrum<Config>;
+
+		LPSR_FASTCODE void process(const Input& spectrum, Output& melPower) {
+#ifdef LPSR_MEL_REFERENCE
+			processReference(spectrum);
+#endif
+			PROFILE_ZONE("mel");
+#ifdef LPSR_UNROLLED_MEL
+			mfcc::UnrolledMelFilterbank<filterbank>::evaluatePower(spectrum.data(), melPower);
+#else
+			filterbank.evaluatePower(spectrum.data(), melPower);
+#endif
+			for (float& power : melPower) {
+				power = fastmath::log2<Config::logApproximationDegree>(power);
+			}
+		}
+
+	private:
+#ifdef LPSR_MEL_REFERENCE
+		// Its result is only kept so the work is not optimized away
+		LPSR_FASTCODE void processReference(const Input& spectrum) {
+			PROFILE_ZONE("mel-ref");
+			arm_cmplx_mag_squared_f32(const_cast<float*>(spectrum.data()), referencePower.data(), Config::fftSize / 2);
+			for (int i = 1; i <= Config::numMelFilters; i++) {
+				referenceMelPower[i - 1] = filterbank.evaluate(referencePower, i);
+			}
+		}
+
+		std::array<float, Config::fftSize / 2> referencePower;
+		Output referenceMelPower;
+#endif
+
+		LPSR_FASTDATA static constexpr MelFilterbank filterbank{};
+		static_assert(filterbank.segmentsCoverFilters());
+		static_assert(MelFilterbank::endBin <= Config::fftSize / 2);
+	};
+
+	// The whole mel cepstrum
+	template<typename Config>
+	class Cepstrum {
+	public:
+		using DctTable = DiscreteCosineTransformTable<Config::numMelFilters>;
+
+		using Input = MelSpectrum<Config>;
+		using Output = MelSpectrum<Config>;
+
+		LPSR_FASTCODE void process(const Input& melPower, Output& cepstrum) {
+			PROFILE_ZONE("dct");
+			for (int i = 0; i < Config::numMelFilters; i++) {
+				cepstrum[i] = dctLut.evaluate(melPower, i);
+			}
+		}
+
+	private:
+		LPSR_FASTDATA static constexpr DctTable dctLut{};
+	};
+
+	// The scaled feature vector from only the DCT rows it needs
+	template<typename Config>
+	class Features {
+	public:
+		using DctTable = DiscreteCosineTransformTable<Config::numMelFilters, Config::firstCoefficient, Config::lastCoefficient>;
+
+		using Input = MelSpectrum<Config>;
+		using Output = std::array<float, Config::featureVectorDim>;
+
+		LPSR_FASTCODE void process(const Input& melPower, Output& featureVector) {
+			PROFILE_ZONE("dct");
+			computeFeatureVector(dctLut, melPower, featureVector);
+		}
+
+	private:
+		LPSR_FASTDATA static constexpr DctTable dctLut{};
+	};
+}
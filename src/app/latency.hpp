@@ -0,0 +1,52 @@
+#pragma once
+#include <algorithm>
+#include <array>
+#include <cstdint>
+
+/**
+ * End-to-end latency tracing, measured on the sample clock.
+ *
+ * Every block of samples is tagged with the index of its first sample,
+ * counted since startup. Latencies are differences of sample indices, so they
+ * are exact on the target and in host replays alike. At 9.65 kHz the 32-bit
+ * index wraps after about 124 hours, differences stay correct across the wrap.
+ */
+namespace latency {
+
+	using SampleIndex = uint32_t;
+
+	// Keeps the last Capacity latencies and reports percentiles over them.
+	template<int Capacity>
+	class Tracker {
+	public:
+		void add(uint32_t latencySamples) {
+			samples[next] = latencySamples;
+			next = (next + 1 < Capacity) ? next + 1 : 0;
+			count = (count < Capacity) ? count + 1 : Capacity;
+		}
+
+		// Nearest-rank percentile, 0 if nothing was recorded
+		uint32_t percentile(int percent) const {
+			if (count == 0) return 0;
+			std::array<uint32_t, Capacity> sorted;
+			std::copy(samples.begin(), samples.begin() + count, sorted.begin());
+			int rank = (percent * count + 99) / 100;
+			rank = std::min(std::max(rank, 1), count);
+			std::nth_element(sorted.begin(), sorted.begin() + (rank - 1), sorted.begin() + count);
+			return sorted[rank - 1];
+		}
+
+		int size() const {
+			return count;
+		}
+
+	private:
+		std::array<uint32_t, Capacity> samples = {};
+		int next = 0;
+		int count = 0;
+	};
+
+	constexpr uint32_t samplesToMicroseconds(uint32_t samples, uint32_t sampleRate) {
+		return static_cast<uint32_t>(uint64_t(samples) * 1'000'000 / sampleRate);
+	}
+}
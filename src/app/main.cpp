@@ -4,87 +4,131 @@
 #include <atomic>
 #include <algorithm>
 #include <numeric>
+#include <cstring>
 
 #include "arm_math.h"
 
+#include <modm/architecture/interface/atomic_lock.hpp>
 #include <modm/architecture/interface/delay.hpp>
 #include <modm/platform.hpp>
 #include <modm/processing/timer.hpp>
 
 #include <common/board.hpp>
 #include <common/timekeeping.hpp>
-
-#include "transform.hpp"
-#include "mfcc.hpp"
-#include "dtw.hpp"
+#include <common/profiler.hpp>
+#include <common/cycle_counter.hpp>
+#include <common/flash.hpp>
+#include <common/spsc_queue.hpp>
+
+#include "parameters.hpp"
+#include "feature_vector.hpp"
+#include "telemetry.hpp"
+#include "frame_budget.hpp"
+#include "latency.hpp"
+#include "template_db.hpp"
+#include "template_upload.hpp"
+#include "enrollment.hpp"
+#include "vocabulary.hpp"
+#include "recognizer.hpp"
+#include "duty_cycle.hpp"
 
 // Hardware definitions
 using MicrophoneInput = modm::platform::GpioInputA0;
 using Adc = modm::platform::Adc1;
 using AdcInterrupt = modm::platform::AdcInterrupt1;
 
-// Sampling and FFT parameters
-constexpr int oversampleRatio = 16;
-constexpr int sampleRate = 12800; // ADC settings must be manually changed to match this
-constexpr int windowStride = 256;
-constexpr int windowSize = windowStride * 2;
-
-// MFCC parameters
-constexpr int numMelCoefficients = 16;
-constexpr int featureVectorFirstCoefficient = 2;
-constexpr int featureVectorLastCoefficient = 9;
-constexpr int featureVectorDim = featureVectorLastCoefficient - featureVectorFirstCoefficient;
-constexpr int maxWords = 64;
-
-// Lookup tables
-constexpr HannWindow<windowSize> fftWindowingLut;
-constexpr mfcc::MelFilterLut<numMelCoefficients, 0, 3000, windowSize, sampleRate> melFilterLut;
-constexpr DiscreteCosineTransformTable<16> dctLut;
-
-// Buffers
-std::array<uint16_t, windowSize> rawSamples;
-std::array<float, windowSize> normalizedSamples;
-std::array<float, windowSize> fftSamples;
-std::array<float, windowSize / 2> spectrumPower;
-std::array<float, numMelCoefficients> melPower;
-std::array<float, numMelCoefficients> melCepstrum;
-using FeatureVector = std::array<float, featureVectorDim>;
-FeatureVector featureVector;
-std::array<FeatureVector, maxWords> wordBuffer;
-std::array<uint32_t, 20> dtwResults;
-
-// Necessary for ARM FFT function
-arm_rfft_fast_instance_f32 fftSettings;
-
-// Dynamic time warping object
-Dtw<64, FeatureVector> dtwWorkspace;
-
-// We must specify a distance metric for each type used with the DTW algorithm
-template<>
-uint32_t dtw::distanceMetric(const FeatureVector& a, const FeatureVector& b) {
-	float magnitudeSquared = 0;
-	for (size_t i = 0; i < std::tuple_size<FeatureVector>::value; i++) {
-		magnitudeSquared += (b[i] - a[i]) * (b[i] - a[i]);
+static_assert(ClockConfiguration::Adc == Pipeline::adcClock, "the pipeline's ADC timing assumes another clock");
+
+constexpr Adc::SampleTime adcSampleTime(int cycles) {
+	switch (cycles) {
+		case 3: return Adc::SampleTime::Cycles3;
+		case 15: return Adc::SampleTime::Cycles15;
+		case 28: return Adc::SampleTime::Cycles28;
+		case 56: return Adc::SampleTime::Cycles56;
+		case 84: return Adc::SampleTime::Cycles84;
+		case 112: return Adc::SampleTime::Cycles112;
+		case 144: return Adc::SampleTime::Cycles144;
+		default: return Adc::SampleTime::Cycles480;
 	}
-	return std::sqrt(magnitudeSquared) * 65536.0;
 }
 
-// Voice command data in another file
-struct VoiceCommandEntry {
-	const char* text;
-	const FeatureVector* featureVectors;
-	int numFeatureVectors;
+// The wait primitive of duty::Meter: WFI with interrupts masked by PRIMASK,
+// a pending interrupt still wakes the core and runs once unmasked. Its ticks
+// are the microseconds of TIM5, which keeps counting in Sleep mode. The DWT
+// cycle counter stops with the core clock in WFI unless DBGMCU_CR.DBG_SLEEP
+// keeps that clock running, which would cost the power sleeping saves.
+struct CoreSleep {
+	void lock() { __disable_irq(); }
+	void unlock() { __enable_irq(); }
+	void wait() {
+		__DSB();
+		__WFI();
+	}
+	uint32_t now() { return timekeeping::now(); }
 };
 
-extern const VoiceCommandEntry voiceCommands[];
-extern int numVoiceCommands;
+// Template database in its own flash sectors, see scripts/linkerscript.ld
+extern "C" const uint8_t __templates_start[];
+extern "C" const uint8_t __templates_end[];
+
+flash::Region templateRegion(__templates_start, __templates_end);
+templatedb::Database templates;
+TemplateUpload<flash::Region> templateUpload(templateRegion);
+
+// Templates enrolled on the device, two banks in flash
+extern "C" const uint8_t __enrollment_start[];
+extern "C" const uint8_t __enrollment_end[];
+
+const uint8_t* const enrollmentBankSplit = __enrollment_start + (__enrollment_end - __enrollment_start) / 2;
+flash::Region enrollmentBankA(__enrollment_start, enrollmentBankSplit);
+flash::Region enrollmentBankB(enrollmentBankSplit, __enrollment_end);
+enrollment::Log<flash::Region, featureVectorDim, maxEnrolledTemplates> enrolledTemplates(enrollmentBankA, enrollmentBankB);
+
+// Everything the recognizer searches
+using FirmwareVocabulary = Vocabulary<FeatureVector, maxTemplates + maxEnrolledTemplates>;
+FirmwareVocabulary vocabulary;
+
+// The second half of the pipeline, from feature frames to words, runs in thread mode
+WordRecognizer<FirmwareVocabulary> wordRecognizer(vocabulary);
+
+void rebuildVocabulary() {
+	vocabulary.clear();
+	for (int i = 0; i < templates.size(); i++) {
+		vocabulary.add(templates.text(i), templates.frames<featureVectorDim>(i), templates.numFrames(i));
+	}
+	for (int i = 0; i < enrolledTemplates.size(); i++) {
+		vocabulary.add(enrolledTemplates.text(i), enrolledTemplates.frames(i), enrolledTemplates.numFrames(i));
+	}
+}
+
+// Opens the database in flash, leaves it closed if it is not usable
+templatedb::Error loadTemplates() {
+	templatedb::Error error = templates.open(templateRegion.data(), templateRegion.size());
+	if (error == templatedb::Error::None) {
+		error = templates.check(featureVectorDim, maxTemplates, maxTemplateFrames);
+	}
+	if (error != templatedb::Error::None) {
+		templates.close();
+	}
+	rebuildVocabulary();
+	return error;
+}
 
 namespace AdcInterruptHandler {
 
+	struct BlockInfo {
+		// Cycle counter value when the block was complete
+		uint32_t readyTime;
+		// Index of the first sample of the block since startup
+		latency::SampleIndex sampleIndex;
+	};
+
 	namespace {
 		constexpr int numBuffers = 3;
 		volatile uint16_t buffer[numBuffers][windowStride];
 		int bufferIdx;
+		BlockInfo bufferInfo[numBuffers];
+		std::atomic<latency::SampleIndex> sampleIndex = 0;
 		std::atomic<volatile uint16_t*> availableBuffer = nullptr;
 		size_t bufferPos;
 		uint32_t oversampleAccumulator;
@@ -92,6 +136,8 @@ namespace AdcInterruptHandler {
 	}
 
 	std::atomic<int> samplesComplete = 0;
+	// Blocks that were replaced by a newer one before feature extraction picked them up
+	std::atomic<uint32_t> blocksLost = 0;
 
 	void handler() {
 		if (Adc::getInterruptFlags() &  Adc::InterruptFlag::EndOfRegularConversion) {
@@ -105,10 +151,17 @@ namespace AdcInterruptHandler {
 				oversampleAccumulator = 0;
 				if (bufferPos == windowStride) {
 					bufferPos = 0;
-					availableBuffer = buffer[bufferIdx++];
+					bufferInfo[bufferIdx].readyTime = cycleCounter::now();
+					bufferInfo[bufferIdx].sampleIndex = sampleIndex + 1 - windowStride;
+					if (availableBuffer.exchange(buffer[bufferIdx++]) != nullptr) {
+						blocksLost += 1;
+					}
+					// Feature extraction runs in PendSV_Handler
+					SCB->ICSR = SCB_ICSR_PENDSVSET_Msk;
 					bufferIdx = (bufferIdx < numBuffers) ? bufferIdx : 0;
 				}
 				samplesComplete += 1;
+				sampleIndex += 1;
 			}
 		}
 		//Adc::acknowledgeInterruptFlags(Adc::InterruptFlag::All);
@@ -133,6 +186,16 @@ namespace AdcInterruptHandler {
 		return const_cast<const uint16_t*>(availableBuffer.exchange(nullptr));
 	}
 
+	// Timing of a buffer returned by getBuffer()
+	BlockInfo getBlockInfo(const uint16_t* samples) {
+		return bufferInfo[(samples - const_cast<const uint16_t*>(buffer[0])) / windowStride];
+	}
+
+	// Index of the next sample to be completed, i.e. the current time on the sample clock
+	latency::SampleIndex now() {
+		return sampleIndex;
+	}
+
 	// Blocks until a buffer is ready,
 	const uint16_t* getBufferBlocking() {
 		const uint16_t* retval;
@@ -141,6 +204,108 @@ namespace AdcInterruptHandler {
 	}
 };
 
+/**
+ * The first half of the pipeline, from blocks of samples to feature frames.
+ *
+ * It runs in PendSV at the lowest priority, pended by the ADC interrupt for
+ * every block. So it preempts the recognition in thread mode, however long
+ * DTW takes, and only the ADC and UART interrupts preempt it. The frames go
+ * to thread mode through a lock-free queue.
+ */
+namespace FeatureInterruptHandler {
+
+	// One frame handed to thread mode
+	struct Frame {
+		FeatureFrame features;
+		float amplitude;
+		// Only valid if features.hasCepstrum is set
+		std::array<float, numMelCoefficients> cepstrum;
+	};
+
+	enum SnapshotRequest : uint8_t {
+		SnapshotRaw = 1,
+		SnapshotSpectrum = 2,
+	};
+
+	// Samples and spectrum of one block for the raw and spec telemetry
+	struct Snapshot {
+		uint8_t contents;
+		std::array<uint16_t, FrontEnd::fftSize> samples;
+		std::array<float, FrontEnd::fftSize / 2> spectrum;
+	};
+
+	// Each block has to be processed before the next one is complete
+	constexpr uint32_t frameBudgetCycles = uint64_t(windowStride) * cycleCounter::frequency / sampleRate;
+
+	namespace {
+		FeatureExtractor featureExtractor;
+	}
+
+	SpscQueue<Frame, featureQueueSize> frames;
+	// Frames that did not fit the queue because thread mode fell behind
+	std::atomic<uint32_t> framesDropped = 0;
+	// Set by thread mode while the telemetry may print the cepstrum
+	std::atomic<bool> cepstrumWanted = false;
+	// SnapshotRequest bits set by thread mode, the snapshot is taken from the next block
+	std::atomic<uint8_t> snapshotRequest = 0;
+	// Set once the snapshot is taken, thread mode clears it when done printing
+	std::atomic<bool> snapshotReady = false;
+	Snapshot snapshot;
+	// Thread mode must only access it with interrupts locked
+	budget::FrameBudget frameBudget(frameBudgetCycles);
+
+	void processBlock(const uint16_t* samples) {
+		PROFILE_ZONE("frame");
+		AdcInterruptHandler::BlockInfo blockInfo = AdcInterruptHandler::getBlockInfo(samples);
+		frameBudget.beginFrame(blockInfo.readyTime, cycleCounter::now());
+
+		// Decide if a word might be spoken from the amplitude
+		featureExtractor.addBlock(samples, blockInfo.sampleIndex);
+
+		frameBudget.endStage(budget::Stage::Preprocess, cycleCounter::now());
+
+		// Only run the front end if the recognizer or the telemetry needs its output
+		const uint8_t request = snapshotReady ? 0 : snapshotRequest.exchange(0);
+		featureExtractor.computeFeatures(cepstrumWanted || (request & SnapshotSpectrum));
+
+		frameBudget.endStage(budget::Stage::Features, cycleCounter::now());
+
+		Frame frame;
+		frame.features = featureExtractor.frame();
+		frame.amplitude = featureExtractor.frontEnd().amplitude();
+		if (frame.features.hasCepstrum) {
+			frame.cepstrum = featureExtractor.frontEnd().cepstrum();
+		}
+		if (!frames.push(frame)) {
+			framesDropped += 1;
+		}
+
+		if (request != 0) {
+			snapshot.contents = request;
+			if (request & SnapshotRaw) {
+				snapshot.samples = featureExtractor.frontEnd().samples();
+			}
+			if (request & SnapshotSpectrum) {
+				featureExtractor.frontEnd().computeSpectrum(snapshot.spectrum);
+			}
+			snapshotReady = true;
+		}
+
+		frameBudget.endFrame(cycleCounter::now());
+	}
+
+	void initialize() {
+		NVIC_SetPriority(PendSV_IRQn, (1 << __NVIC_PRIO_BITS) - 1);
+	}
+}
+
+extern "C" void PendSV_Handler() {
+	const uint16_t* samples;
+	while ((samples = AdcInterruptHandler::getBuffer()) != nullptr) {
+		FeatureInterruptHandler::processBlock(samples);
+	}
+}
+
 int main(void) {
 	initCommon();
 
@@ -154,231 +319,250 @@ int main(void) {
 	// Configure ADC
 	MicrophoneInput::setInput(modm::platform::Gpio::InputType::PullUp);
 	Adc::connect<MicrophoneInput::In0>();
-	Adc::initialize<ClockConfiguration, ClockConfiguration::Adc / 8>();
-	Adc::setPinChannel<MicrophoneInput>(Adc::SampleTime::Cycles56);
+	// Converts continuously at the rate of the pipeline's ADC settings
+	Adc::initialize<ClockConfiguration, ClockConfiguration::Adc / Pipeline::adcPrescaler>();
+	Adc::setPinChannel<MicrophoneInput>(adcSampleTime(Pipeline::adcSampleCycles));
 
-	// Attach interrupt and start ADC
+	// Attach interrupts and start ADC
+	FeatureInterruptHandler::initialize();
 	AdcInterruptHandler::initialize();
 
-	// Timer for performance information
+	// Timers for performance information, TIM5 also measures the sleep
 	timekeeping::initTimer();
+	cycleCounter::init();
+
+	telemetry::Control telemetryControl;
 
-	// Initialize FFT settings
-	arm_rfft_fast_init_f32(&fftSettings, windowSize);
+	if (!enrolledTemplates.mount()) {
+		serOut << "msg:error: enrollment: flash error" << modm::endl;
+	}
+	templatedb::Error templateError = loadTemplates();
+	// Word to store as a new template when the next word is spoken, empty if not enrolling
+	std::array<char, enrollment::maxTextLength + 1> enrollmentText = {};
+	if (templateError != templatedb::Error::None) {
+		serOut << "msg:error: templates: " << templatedb::errorName(templateError) << modm::endl;
+	}
+	// An upload is aborted if the host stops sending
+	modm::ShortTimeout uploadTimeout;
 
-	modm::ShortPeriodicTimer powerSpectrumTimer(100);
 	modm::ShortPeriodicTimer framesPerSecondTimer(1000);
 	int frames = 0;
+	float amplitude = 0;
 
-	int wordLength = 0;
-	constexpr int maxQuietGap = 7;
-	int quietGapCounter = 0;
-	float amplitudeThreshold = 0.01;
-
-	uint32_t startTime = 0;
-	uint32_t copyTime = 0;
-	uint32_t averagingTime = 0;
-	uint32_t normalizationTime = 0;
-	uint32_t tresholdTime = 0;
-
-	uint32_t fftStartTime = 0;
-	uint32_t fftTime = 0;
-	uint32_t magTime = 0;
-	uint32_t melFilterTime = 0;
-	uint32_t dctTime = 0;
-	uint32_t featureScalingTime = 0;
-
-	uint32_t dtwStartTime = 0;
-	uint32_t dtwTime = 0;
+	// Time from the end of speech until the recognition result is printed
+	latency::Tracker<32> decisionLatency;
 
-	float rmsAmplitude = 0.0;
+	// Every ADC conversion, UART character, SysTick and feature frame wakes the core
+	CoreSleep coreSleep;
+	duty::Meter<CoreSleep> dutyMeter(coreSleep);
 
 	while (1) {
-		const uint16_t* newSamples;
-		if ((newSamples = AdcInterruptHandler::getBuffer()) != nullptr) {
-
-			startTime = timekeeping::now();
-
-			// Shift old samples and copy new samples to buffer
-			std::copy(rawSamples.begin() + windowStride, rawSamples.end(), rawSamples.begin());
-			std::copy(newSamples, newSamples + windowStride, rawSamples.end() - windowStride);
-
-			copyTime = timekeeping::now();
-
-			// Take the mean of the samples so it can be subtracted during normalization
-			auto sampleSum = std::accumulate(rawSamples.begin(), rawSamples.end(), uint32_t(0));
-			// Make sure the sum was to a uint32_t to prevent overflow
-			static_assert(std::is_same<decltype(sampleSum), uint32_t>::value);
-			float sampleMean = static_cast<float>(sampleSum) / windowSize;
-
-			averagingTime = timekeeping::now();
-
-			// Normalize the samples approximately to the range [-1, 1]
-			// At the same time, take the root-mean-squared amplitude
-			float power = 0;
-			for (int i = 0; i < windowSize; i++) {
-				float normalizedSample = fftWindowingLut[i] * (rawSamples[i] - sampleMean) / 512.0;
-				//maxAmplitude = std::max(std::abs(normalizedSample), maxAmplitude);
-				power += normalizedSample * normalizedSample;
-				normalizedSamples[i] = normalizedSample;
+		uint8_t receivedChar;
+		while (SerialDebug::read(receivedChar)) {
+			if (templateUpload.isActive()) {
+				uploadTimeout.restart(1000);
+				auto status = templateUpload.receive(receivedChar);
+				if (status == TemplateUpload<flash::Region>::Status::ChunkComplete) {
+					serOut << "msg:upload: " << templateUpload.bytesReceived() << modm::endl;
+				}
+				else if (status == TemplateUpload<flash::Region>::Status::Failed) {
+					serOut << "msg:error: upload: flash write failed" << modm::endl;
+				}
+				else if (status == TemplateUpload<flash::Region>::Status::Complete) {
+					templateError = loadTemplates();
+					if (templateError == templatedb::Error::None) {
+						serOut << "msg:upload: done, " << templates.size() << " templates" << modm::endl;
+					}
+					else {
+						serOut << "msg:error: upload: " << templatedb::errorName(templateError) << modm::endl;
+					}
+				}
+				continue;
 			}
-			rmsAmplitude = std::sqrt(power / windowSize);
-
-			normalizationTime = timekeeping::now();
-
-			// Decide if a word might be spoken from the amplitude
-			bool wordFinished = false;
-			bool computeFeatureVector = false;
 
-			if (rmsAmplitude > amplitudeThreshold) {
-				Led::set();
-				wordLength += 1;
-				quietGapCounter = maxQuietGap;
+			telemetry::Result result = telemetryControl.receive(receivedChar);
+			if (result == telemetry::Result::Ok) {
+				serOut << "msg:ok" << modm::endl;
 			}
-			else {
-				Led::reset();
-				if (wordLength > 0) {
-					quietGapCounter -= 1;
-					wordLength += 1;
-					if (quietGapCounter == 0) {
-						wordLength -= maxQuietGap;
-						wordFinished = true;
-					}
+			else if (result == telemetry::Result::Error) {
+				serOut << "msg:error: unknown command" << modm::endl;
+			}
+			else if (result == telemetry::Result::Upload) {
+				// The flash is rewritten, so the old templates are gone from here on
+				templates.close();
+				rebuildVocabulary();
+				if (templateUpload.begin(telemetryControl.uploadSize())) {
+					uploadTimeout.restart(1000);
+					serOut << "msg:upload: ready" << modm::endl;
+				}
+				else {
+					serOut << "msg:error: upload: size must be 1 to " << templateRegion.size() << " bytes" << modm::endl;
+					loadTemplates();
 				}
 			}
-
-			if (!wordFinished && wordLength > 0 && wordLength <= maxWords) {
-				computeFeatureVector = true;
+			else if (result == telemetry::Result::Enroll) {
+				std::strcpy(enrollmentText.data(), telemetryControl.commandText());
+				serOut << "msg:enroll: say " << enrollmentText.data() << modm::endl;
 			}
-
-			tresholdTime = timekeeping::now();
-
-			if (true) {
-				fftStartTime = timekeeping::now();
-				// Take the FFT of the data
-				arm_rfft_fast_f32(&fftSettings, normalizedSamples.data(), fftSamples.data(), 0);
-
-				fftTime = timekeeping::now();
-
-				// Take the magnitude squared (power) of the complex-valued FFT output
-				arm_cmplx_mag_squared_f32(fftSamples.data(), spectrumPower.data(), windowSize / 2);
-
-				magTime = timekeeping::now();
-
-				// Run the power spectrum through the mel filterbank
-				float totalPower = 0.0f;
-				for (int i = 1; i <= numMelCoefficients; i++) {
-					float melFilterPower = melFilterLut.evaluate(spectrumPower, i);
-					totalPower += melFilterPower;
-					melPower[i - 1] = std::log2f(melFilterPower);
+			else if (result == telemetry::Result::Forget) {
+				int removed = enrolledTemplates.forget(telemetryControl.commandText());
+				rebuildVocabulary();
+				if (removed < 0) {
+					serOut << "msg:error: forget: " << enrollment::errorName(enrollment::Error::FlashError) << modm::endl;
 				}
-
-				melFilterTime = timekeeping::now();
-
-				// Take the DCT of the mel spectrum power
-				for (int i = 0; i < numMelCoefficients; i++) {
-					melCepstrum[i] = dctLut.evaluate(melPower, i);
+				else {
+					serOut << "msg:forget: " << removed << " templates" << modm::endl;
 				}
+			}
+		}
 
-				dctTime = timekeeping::now();
+		if (templateUpload.isActive() && uploadTimeout.execute()) {
+			templateUpload.abort();
+			serOut << "msg:error: upload: timeout after " << templateUpload.bytesReceived() << " bytes" << modm::endl;
+		}
 
-				// Keep only certain terms from the DCT, and rescale them to length ln(originalMagnitude - 1)
-				float featureVectorScaling = 0.0;
-				for (int i = featureVectorFirstCoefficient; i < featureVectorLastCoefficient; i++) {
-					featureVectorScaling += melCepstrum[i] * melCepstrum[i];
+		FeatureInterruptHandler::cepstrumWanted = telemetryControl.wanted(telemetry::Stream::Mfcc)
+			|| telemetryControl.wanted(telemetry::Stream::Spectrum);
+
+		FeatureInterruptHandler::Frame frame;
+		if (FeatureInterruptHandler::frames.pop(frame)) {
+			const FeatureFrame& features = frame.features;
+			Led::set(features.segment.loud);
+			const bool wordFinished = wordRecognizer.addFrame(features);
+			const int wordLength = features.segment.wordLength;
+			amplitude = frame.amplitude;
+
+			bool emitMfcc = telemetryControl.due(telemetry::Stream::Mfcc);
+			uint8_t snapshotRequest = 0;
+			if (telemetryControl.due(telemetry::Stream::Raw)) {
+				snapshotRequest |= FeatureInterruptHandler::SnapshotRaw;
+			}
+			if (telemetryControl.due(telemetry::Stream::Spectrum)) {
+				snapshotRequest |= FeatureInterruptHandler::SnapshotSpectrum;
+			}
+			FeatureInterruptHandler::snapshotRequest |= snapshotRequest;
+
+			if (wordFinished && enrollmentText[0] != '\0') {
+				// Writing may compact the log, which stalls the CPU while a flash sector is erased
+				enrollment::Error error = enrolledTemplates.append(enrollmentText.data(), wordRecognizer.word(), wordLength);
+				if (error == enrollment::Error::None) {
+					serOut << "msg:enroll: stored " << enrollmentText.data() << ", " << wordLength << " frames, ";
+					serOut << enrolledTemplates.bytesFree() << " bytes free" << modm::endl;
 				}
-				featureVectorScaling = std::sqrt(featureVectorScaling);
-				featureVectorScaling = std::log(featureVectorScaling + 1.0) / featureVectorScaling;
-				for (int i = featureVectorFirstCoefficient; i < featureVectorLastCoefficient; i++) {
-					featureVector[i - featureVectorFirstCoefficient] = melCepstrum[i] * featureVectorScaling;
+				else {
+					serOut << "msg:error: enroll: " << enrollment::errorName(error) << modm::endl;
 				}
-
-				featureScalingTime = timekeeping::now();
-			}
-
-			if (computeFeatureVector) {
-				wordBuffer[wordLength - 1] = featureVector;
+				enrollmentText[0] = '\0';
+				rebuildVocabulary();
 			}
-
-			if (wordFinished && wordLength > 4) {
+			else if (wordFinished) {
 				serOut << "msg: " << wordLength << modm::endl;
 				serOut << "msg:word length: " << wordLength << modm::endl;
 
-				dtwStartTime = timekeeping::now();
-				for (int i = 0; i < numVoiceCommands; i++) {
-					dtwResults[i] = dtwWorkspace.compare(
-						voiceCommands[i].featureVectors, voiceCommands[i].numFeatureVectors,
-						wordBuffer.data(), wordLength
-					);
-				}
-				dtwTime = timekeeping::now();
-
-				uint32_t bestMatch = std::numeric_limits<uint32_t>::max();
-				int bestMatchIdx = -1;
-				for (int i = 0; i < numVoiceCommands; i++) {
-					if (bestMatch >= dtwResults[i]) {
-						bestMatch = dtwResults[i];
-						bestMatchIdx = i;
-					}
-				}
+				auto recognition = wordRecognizer.recognize();
 
-				for (int i = 0; i < numVoiceCommands; i++) {
-					serOut << "msg:score: " << voiceCommands[i].text << ", "<< dtwResults[i] << modm::endl;
+				if (telemetryControl.due(telemetry::Stream::Scores)) {
+					for (int i = 0; i < vocabulary.size(); i++) {
+						serOut << "msg:score: " << vocabulary[i].text << ", "<< wordRecognizer.cost(i) << modm::endl;
+					}
 				}
 
-				if (bestMatchIdx >= 0) {
-					serOut << "msg:best match: " << voiceCommands[bestMatchIdx].text << modm::endl;
+				if (recognition.commandIdx >= 0) {
+					serOut << "msg:best match: " << vocabulary[recognition.commandIdx].text << modm::endl;
+					// Sample clock when the result is available
+					latency::SampleIndex decision = AdcInterruptHandler::now();
+					uint32_t latencySamples = decision - recognition.speechEnd;
+					decisionLatency.add(latencySamples);
+					serOut << "msg:latency: " << latency::samplesToMicroseconds(latencySamples, sampleRate) << "us";
+					serOut << " duration: " << latency::samplesToMicroseconds(recognition.speechEnd - recognition.speechStart, sampleRate) << "us";
+					serOut << modm::endl;
 				}
-
-				wordLength = 0;
 			}
 
 			frames += 1;
 
-			if (true) {
+			if (emitMfcc && features.hasCepstrum) {
 				serOut << "mfcc:";
-				serOut << rmsAmplitude << " ";
+				serOut << frame.amplitude << " ";
 				for (int i = 1; i < numMelCoefficients; i++) {
-					serOut << melCepstrum[i] << " ";
+					serOut << frame.cepstrum[i] << " ";
 				}
 				serOut << modm::endl;
 			}
 		}
 
-		if (framesPerSecondTimer.execute()) {
-			serOut << "stat: fps:" << frames << " samplerate:" << AdcInterruptHandler::samplesComplete.exchange(0);
-			serOut << " copy:" << copyTime - startTime;
-			serOut << " avg:" << averagingTime - copyTime;
-			serOut << " normal:" << normalizationTime - averagingTime;
-			serOut << " tresh:" << tresholdTime - normalizationTime;
-			serOut << " fft:" << fftTime - fftStartTime;
-			serOut << " mag:" << magTime - fftTime;
-			serOut << " mel:" << melFilterTime - magTime;
-			serOut << " dct:" << dctTime - melFilterTime;
-			serOut << " fvscl:" << featureScalingTime - dctTime;
-			serOut << " dtw:" << dtwTime - dtwStartTime;
-			serOut << " at:" << rmsAmplitude;
-			serOut << modm::endl;
-			frames = 0;
+		if (FeatureInterruptHandler::snapshotReady) {
+			const FeatureInterruptHandler::Snapshot& snapshot = FeatureInterruptHandler::snapshot;
+			if (snapshot.contents & FeatureInterruptHandler::SnapshotRaw) {
+				serOut << "raw:";
+				for (uint16_t sample : snapshot.samples) {
+					serOut << sample << " ";
+				}
+				serOut << modm::endl;
+			}
+			if (snapshot.contents & FeatureInterruptHandler::SnapshotSpectrum) {
+				serOut << "spec:";
+				for (float power : snapshot.spectrum) {
+					serOut << power << " ";
+				}
+				serOut << modm::endl;
+			}
+			FeatureInterruptHandler::snapshotReady = false;
 		}
 
-		if (powerSpectrumTimer.execute()) {
-			/*MODM_LOG_INFO << "raw:";
-			for (int i = 0; i < windowSize; i++) {
-				MODM_LOG_INFO << rawSamples[i] << " ";
+		if (framesPerSecondTimer.execute()) {
+			int samplesComplete = AdcInterruptHandler::samplesComplete.exchange(0);
+			uint32_t framesDropped = FeatureInterruptHandler::framesDropped.exchange(0);
+			duty::Counters dutyCounters = dutyMeter.takePeriod();
+			budget::Counters budgetCounters;
+			budget::Counters totalCounters;
+			{
+				// The feature interrupt updates the budget
+				modm::atomic::Lock lock;
+				FeatureInterruptHandler::frameBudget.addLostBlocks(AdcInterruptHandler::blocksLost.exchange(0));
+				budgetCounters = FeatureInterruptHandler::frameBudget.period();
+				totalCounters = FeatureInterruptHandler::frameBudget.total();
+				FeatureInterruptHandler::frameBudget.resetPeriod();
 			}
-			MODM_LOG_INFO << modm::endl;*/
-
-			/*MODM_LOG_INFO << "spec:";
-			for (int i = 0; i < windowSize / 2; i++) {
-				MODM_LOG_INFO << static_cast<int>(spectrumPowerSquared[i]) << " ";
+			if (telemetryControl.due(telemetry::Stream::Stats)) {
+				constexpr int32_t cyclesPerMicrosecond = cycleCounter::frequency / 1'000'000;
+				serOut << "stat: fps:" << frames << " samplerate:" << samplesComplete;
+				serOut << " at:" << amplitude;
+				serOut << " miss:" << budgetCounters.deadlineMisses;
+				serOut << " lost:" << budgetCounters.lostBlocks;
+				serOut << " drop:" << framesDropped;
+				if (budgetCounters.frames > 0) {
+					serOut << " slack:" << budgetCounters.worstSlack / cyclesPerMicrosecond << "us";
+				}
+				for (int i = 0; i < budget::numStages; i++) {
+					if (budgetCounters.overruns[i] > 0) {
+						serOut << " over_" << budget::stageNames[i] << ":" << budgetCounters.overruns[i];
+					}
+				}
+				serOut << " totalmiss:" << totalCounters.deadlineMisses;
+				serOut << " totallost:" << totalCounters.lostBlocks;
+				if (decisionLatency.size() > 0) {
+					serOut << " lat_p50:" << latency::samplesToMicroseconds(decisionLatency.percentile(50), sampleRate) << "us";
+					serOut << " lat_p90:" << latency::samplesToMicroseconds(decisionLatency.percentile(90), sampleRate) << "us";
+					serOut << " lat_max:" << latency::samplesToMicroseconds(decisionLatency.percentile(100), sampleRate) << "us";
+				}
+				serOut << " active:" << dutyCounters.activeTicks << "us";
+				serOut << " sleep:" << dutyCounters.sleepTicks << "us";
+				serOut << " duty:" << dutyCounters.activePerMille() / 10 << "." << dutyCounters.activePerMille() % 10 << "%";
+				serOut << modm::endl;
 			}
-			MODM_LOG_INFO << modm::endl;*/
-
+			if (telemetryControl.due(telemetry::Stream::Profile)) {
+				profiler::dump(serOut);
+				serOut << modm::flush;
+			}
+			frames = 0;
 		}
 
-
-
+		// Characters that arrived before interrupts were masked wait for the next
+		// wake-up, at most one ADC conversion later
+		dutyMeter.idle([] {
+			return !FeatureInterruptHandler::frames.empty() || FeatureInterruptHandler::snapshotReady;
+		});
 	}
 
 	while(1);
@@ -1,5 +1,9 @@
 #pragma once
+#include <algorithm>
 #include <array>
+#include <cstdint>
+#include <type_traits>
+#include <utility>
 
 #include <gcem.hpp>
 
@@ -92,10 +96,36 @@ namespace mfcc {
 		return sum;
 	}
 
+	// First and one past the last FFT bin with weight in any filter
+	constexpr int melFilterbankFirstBin(int numFilters, Float minFreq, Float maxFreq, int fftSize, Float sampleFreq) {
+		int first = fftSize;
+		for (int filterIdx = 1; filterIdx <= numFilters; filterIdx++) {
+			int bin = melFilterLowestActiveBin(filterIdx, numFilters, minFreq, maxFreq, fftSize, sampleFreq);
+			first = (bin < first) ? bin : first;
+		}
+		return first;
+	}
+
+	constexpr int melFilterbankEndBin(int numFilters, Float minFreq, Float maxFreq, int fftSize, Float sampleFreq) {
+		int end = 0;
+		for (int filterIdx = 1; filterIdx <= numFilters; filterIdx++) {
+			int bin = melFilterLowestActiveBin(filterIdx, numFilters, minFreq, maxFreq, fftSize, sampleFreq)
+				+ melFilterNumActiveBins(filterIdx, numFilters, minFreq, maxFreq, fftSize, sampleFreq);
+			end = (bin > end) ? bin : end;
+		}
+		return end;
+	}
+
 	template<int numFilters, int minFreq, int maxFreq, int fftSize, int sampleFreq, typename T = float>
 	class MelFilterLut {
 	public:
-		constexpr MelFilterLut() : lut(), filterInfo() {
+		// The bins evaluatePower() reads
+		static constexpr int firstBin = melFilterbankFirstBin(numFilters, minFreq, maxFreq, fftSize, sampleFreq);
+		static constexpr int endBin = melFilterbankEndBin(numFilters, minFreq, maxFreq, fftSize, sampleFreq);
+		static constexpr int numBandBins = endBin - firstBin;
+		static_assert(endBin <= fftSize / 2);
+
+		constexpr MelFilterLut() : lut(), filterInfo(), binWeights(), segmentEnd() {
 			for (int n = 0; n < lutSize; n++) {
 				lut[n] = 0;
 			}
@@ -110,6 +140,34 @@ namespace mfcc {
 					lutIdx++;
 				}
 			}
+
+			// Adjacent filters overlap, so the band splits into one segment per
+			// filter, from its first bin not in the filter below to its last bin.
+			// A bin of segment k has weight in filter k and possibly k + 1.
+			for (int filter = 0; filter < numFilters; filter++) {
+				segmentEnd[filter] = filterInfo[filter].lowestActiveBin + filterInfo[filter].numActiveBins - firstBin;
+				if (filter > 0 && segmentEnd[filter] < segmentEnd[filter - 1]) {
+					segmentEnd[filter] = segmentEnd[filter - 1];
+				}
+			}
+			int filter = 0;
+			for (int i = 0; i < numBandBins; i++) {
+				while (i >= segmentEnd[filter]) filter++;
+				binWeights[i].lower = get(firstBin + i, filter + 1);
+				binWeights[i].upper = get(firstBin + i, filter + 2);
+			}
+		}
+
+		// Whether no bin has weight in filters beyond its segment's two, which evaluatePower() relies on
+		constexpr bool segmentsCoverFilters() const {
+			int filter = 0;
+			for (int i = 0; i < numBandBins; i++) {
+				while (i >= segmentEnd[filter]) filter++;
+				for (int other = 0; other < numFilters; other++) {
+					if (other != filter && other != filter + 1 && isActive(firstBin + i, other)) return false;
+				}
+			}
+			return true;
 		}
 
 		constexpr T get(int binIdx, int filterIdx) const {
@@ -142,7 +200,54 @@ namespace mfcc {
 			return total;
 		}
 
+		// The power of every filter, straight from the interleaved complex FFT
+		// output: walks the bins between firstBin and endBin once, computes their
+		// power and adds it to both filters the bin falls in, kept in two running
+		// sums. Bins outside the filterbank are never touched. Gives the same
+		// sums as evaluate() on the power spectrum, each filter adds its bins in
+		// the same order.
+		void evaluatePower(const float* fftOutput, std::array<T, numFilters>& filterPower) const {
+			const float* bins = fftOutput + 2 * firstBin;
+			T upper = 0;
+			int i = 0;
+			for (int filter = 0; filter < numFilters; filter++) {
+				// The bins below this segment were added as the upper filter of the last one
+				T lower = upper;
+				upper = 0;
+				for (; i < segmentEnd[filter]; i++) {
+					const float real = bins[2 * i];
+					const float imag = bins[2 * i + 1];
+					const float power = real * real + imag * imag;
+					lower += power * binWeights[i].lower;
+					upper += power * binWeights[i].upper;
+				}
+				filterPower[filter] = lower;
+			}
+		}
+
+		// The filter of the segment bin i of the band (counted from firstBin) is
+		// in, and the bin's weights in it and the filter above, for
+		// UnrolledMelFilterbank
+		constexpr int segment(int i) const {
+			int filter = 0;
+			while (i >= segmentEnd[filter]) filter++;
+			return filter;
+		}
+
+		constexpr T lowerWeight(int i) const {
+			return binWeights[i].lower;
+		}
+
+		constexpr T upperWeight(int i) const {
+			return binWeights[i].upper;
+		}
+
 	private:
+		constexpr bool isActive(int binIdx, int filter) const {
+			return binIdx >= filterInfo[filter].lowestActiveBin
+				&& binIdx < filterInfo[filter].lowestActiveBin + filterInfo[filter].numActiveBins;
+		}
+
 		static constexpr int lutSize = melFilterLutSize(numFilters, minFreq, maxFreq, fftSize, sampleFreq);
 		std::array<T, lutSize> lut;
 
@@ -152,6 +257,60 @@ namespace mfcc {
 			int numActiveBins;
 		};
 		std::array<FilterEntry, numFilters> filterInfo;
+
+		// For evaluatePower(), the weights of each bin between firstBin and endBin
+		// in the filter of its segment and the one above
+		struct BinWeights {
+			T lower;
+			T upper;
+		};
+		std::array<BinWeights, numBandBins> binWeights;
+		// One past the last bin of each filter's segment, relative to firstBin
+		std::array<int16_t, numFilters> segmentEnd;
 	};
-}
 
+	/**
+	 * MelFilterLut::evaluatePower() expanded at compile time into straight-line
+	 * code, for the constexpr filterbank lut: one multiply-accumulate per
+	 * non-zero weight, with the bin offset and the weight as immediates and the
+	 * filter sums in registers. Gives the same sums as the loop, at the cost
+	 * of code size growing with the number of bins in the band.
+	 */
+	template<const auto& lut>
+	class UnrolledMelFilterbank {
+		using Lut = std::remove_cv_t<std::remove_reference_t<decltype(lut)>>;
+
+	public:
+		template<typename T, size_t NumFilters>
+		static void evaluatePower(const float* fftOutput, std::array<T, NumFilters>& filterPower) {
+			// One slot for the upper neighbour of the last filter
+			std::array<T, NumFilters + 1> total = {};
+			accumulate(fftOutput + 2 * Lut::firstBin, total, std::make_index_sequence<Lut::numBandBins>());
+			std::copy(total.begin(), total.begin() + NumFilters, filterPower.begin());
+		}
+
+	private:
+		template<typename T, size_t N, size_t... Bins>
+		static void accumulate(const float* bins, std::array<T, N>& total, std::index_sequence<Bins...>) {
+			(accumulateBin<Bins>(bins, total), ...);
+		}
+
+		template<size_t i, typename T, size_t N>
+		[[gnu::always_inline]] static inline void accumulateBin(const float* bins, std::array<T, N>& total) {
+			constexpr int filter = lut.segment(i);
+			constexpr T lower = lut.lowerWeight(i);
+			constexpr T upper = lut.upperWeight(i);
+			if constexpr (lower != 0 || upper != 0) {
+				const float real = bins[2 * i];
+				const float imag = bins[2 * i + 1];
+				const float power = real * real + imag * imag;
+				if constexpr (lower != 0) {
+					total[filter] += power * lower;
+				}
+				if constexpr (upper != 0) {
+					total[filter + 1] += power * upper;
+				}
+			}
+		}
+	};
+}
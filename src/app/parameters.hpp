@@ -0,0 +1,36 @@
+#pragma once
+
+#include "pipeline_config.hpp"
+
+// Pipeline parameters shared by the firmware and the host tools
+
+// The configuration the firmware and the host tools are built for, the
+// settings are in pipeline_config.hpp. -DDECIMATE=ON selects the decimated one.
+#ifdef LPSR_DECIMATE
+using Pipeline = PipelineConfig<DecimatedPipelineSettings>;
+#else
+using Pipeline = PipelineConfig<DefaultPipelineSettings>;
+#endif
+
+// Sampling and FFT parameters
+constexpr int oversampleRatio = Pipeline::oversampleRatio;
+constexpr int sampleRate = Pipeline::sampleRate;
+constexpr int windowStride = Pipeline::windowStride;
+constexpr int windowSize = Pipeline::windowSize;
+
+// MFCC parameters
+constexpr int numMelCoefficients = Pipeline::numMelFilters;
+constexpr int featureVectorFirstCoefficient = Pipeline::firstCoefficient;
+constexpr int featureVectorLastCoefficient = Pipeline::lastCoefficient;
+constexpr int featureVectorDim = Pipeline::featureVectorDim;
+constexpr int maxWords = Pipeline::maxWordFrames;
+constexpr int logApproximationDegree = Pipeline::logApproximationDegree;
+
+// Recognizer limits, templates beyond these are rejected when loaded
+constexpr int maxTemplates = 20;
+constexpr int maxTemplateFrames = Pipeline::maxTemplateFrames;
+constexpr int maxEnrolledTemplates = 16;
+
+// Frames the feature interrupt can queue for recognition in thread mode, a
+// power of two. 32 frames give the recognition 640 ms before frames are dropped.
+constexpr int featureQueueSize = 32;
@@ -0,0 +1,101 @@
+#pragma once
+#include <algorithm>
+#include <cstdint>
+
+#include <common/utils.hpp>
+
+/**
+ * The shape of the pipeline, from the ADC to the DTW, in one place.
+ *
+ * Settings are a struct of static constexpr members. PipelineConfig<Settings>
+ * checks that they fit together and derives the sizes the front end, the
+ * lookup tables and the recognizer are built from. A variant overrides the
+ * members it changes, so trying a cheaper configuration is one line:
+ *
+ *     struct TwelveFilters : DefaultPipelineSettings {
+ *         static constexpr int numMelFilters = 12;
+ *     };
+ *
+ * and selecting it as Pipeline in parameters.hpp, or comparing it with
+ * frontend_compare and kernel_bench on the host.
+ */
+struct DefaultPipelineSettings {
+	// The ADC runs continuously: its clock is adcClock / adcPrescaler (2, 4,
+	// 6 or 8), a conversion takes adcSampleCycles (3, 15, 28, 56, 84, 112, 144
+	// or 480) plus 12 cycles, and oversampleRatio conversions are averaged
+	// into a sample
+	static constexpr uint32_t adcClock = 84'000'000;
+	static constexpr int adcPrescaler = 8;
+	static constexpr int adcSampleCycles = 56;
+	static constexpr int oversampleRatio = 16;
+
+	// The rate the ADC samples at, it must be within 1% of it. 9651 Hz with
+	// the settings above, which recorded the sessions in data/ and so the
+	// default templates.
+	static constexpr int sampleRate = 9650;
+	static constexpr int windowStride = 256;
+	static constexpr int windowSize = 512;
+	// The front end decimates by this factor before the FFT, 1 or 2
+	static constexpr int decimation = 1;
+
+	// Mel filterbank and the coefficients of the cepstrum in a feature vector.
+	// The filterbank's frequencies are laid out for filterbankSampleRate, not
+	// the real rate: the recorded sessions' features were computed so, and
+	// templates only match features with the same filters in the same FFT
+	// bins. At 9650 Hz this band is 0 to 2262 Hz.
+	static constexpr int filterbankSampleRate = 12800;
+	static constexpr int numMelFilters = 16;
+	static constexpr int melLowFrequency = 0;
+	static constexpr int melHighFrequency = 3000;
+	static constexpr int firstCoefficient = 2;
+	static constexpr int lastCoefficient = 9;
+	// Degree of the fast log2 of the mel energies and the feature scaling, 3
+	// to 7, see common/fast_math.hpp. 5 is within 1.5e-5.
+	static constexpr int logApproximationDegree = 5;
+
+	// Longest word and template, in frames of 26.5 ms. The DTW keeps two rows
+	// of its cost matrix, so they cost little RAM.
+	static constexpr int maxWordFrames = 128;
+	static constexpr int maxTemplateFrames = 128;
+};
+
+// Decimates to 4.8 kHz and runs a 256 point FFT with the same bins
+struct DecimatedPipelineSettings : DefaultPipelineSettings {
+	static constexpr int decimation = 2;
+};
+
+template<typename Settings>
+struct PipelineConfig : Settings {
+	static constexpr int adcConversionCycles = Settings::adcSampleCycles + 12;
+	static constexpr double adcSampleRate = double(Settings::adcClock) / Settings::adcPrescaler / adcConversionCycles / Settings::oversampleRatio;
+
+	// The window as the FFT sees it, after decimation
+	static constexpr int fftSize = Settings::windowSize / Settings::decimation;
+	static constexpr int fftStride = Settings::windowStride / Settings::decimation;
+	static constexpr int fftSampleRate = Settings::sampleRate / Settings::decimation;
+	static constexpr int fftFilterbankSampleRate = Settings::filterbankSampleRate / Settings::decimation;
+
+	static constexpr int featureVectorDim = Settings::lastCoefficient - Settings::firstCoefficient;
+	static constexpr int dtwFrames = std::max(Settings::maxWordFrames, Settings::maxTemplateFrames);
+
+	static_assert(Settings::adcPrescaler == 2 || Settings::adcPrescaler == 4 || Settings::adcPrescaler == 6 || Settings::adcPrescaler == 8);
+	static_assert(Settings::adcClock / Settings::adcPrescaler <= 36'000'000, "the ADC clock is at most 36 MHz");
+	static_assert(Settings::adcSampleCycles == 3 || Settings::adcSampleCycles == 15 || Settings::adcSampleCycles == 28
+		|| Settings::adcSampleCycles == 56 || Settings::adcSampleCycles == 84 || Settings::adcSampleCycles == 112
+		|| Settings::adcSampleCycles == 144 || Settings::adcSampleCycles == 480);
+	static_assert(adcSampleRate > 0.99 * Settings::sampleRate && adcSampleRate < 1.01 * Settings::sampleRate,
+		"the ADC settings do not give the sample rate");
+
+	static_assert(Settings::windowStride > 0 && Settings::windowStride <= Settings::windowSize);
+	static_assert(Settings::decimation == 1 || Settings::decimation == 2, "only a half-band decimator exists");
+	static_assert(Settings::windowStride % Settings::decimation == 0 && Settings::sampleRate % Settings::decimation == 0
+		&& Settings::filterbankSampleRate % Settings::decimation == 0);
+	static_assert(isPowerOf2(fftSize) && fftSize >= 32 && fftSize <= 4096, "arm_rfft_fast_f32 sizes");
+
+	static_assert(0 <= Settings::melLowFrequency && Settings::melLowFrequency < Settings::melHighFrequency);
+	static_assert(Settings::melHighFrequency <= fftFilterbankSampleRate / 2, "the filterbank must end below the Nyquist frequency");
+	static_assert(0 <= Settings::firstCoefficient && Settings::firstCoefficient < Settings::lastCoefficient
+		&& Settings::lastCoefficient <= Settings::numMelFilters);
+	static_assert(Settings::logApproximationDegree >= 3 && Settings::logApproximationDegree <= 7);
+	static_assert(Settings::maxWordFrames > 0 && Settings::maxTemplateFrames > 0);
+};
@@ -0,0 +1,245 @@
+#pragma once
+#include <algorithm>
+#include <array>
+#include <cstdint>
+#include <limits>
+
+#include <common/profiler.hpp>
+
+#include "parameters.hpp"
+#include "front_end.hpp"
+#include "feature_vector.hpp"
+#include "word_segmenter.hpp"
+#include "latency.hpp"
+#include "dtw.hpp"
+#include "vocabulary.hpp"
+
+// Compares a word with every vocabulary entry, stores each DTW cost in costs and
+// returns the index of the cheapest entry (the last one of equal costs), or -1
+// if the vocabulary is empty. The firmware and the host tools decide the same way.
+template<typename FeatureVector, int MaxEntries, int MaxFrames>
+int findBestMatch(const Vocabulary<FeatureVector, MaxEntries>& vocabulary, const FeatureVector* word, int wordLength,
+		Dtw<MaxFrames, FeatureVector>& dtwWorkspace, uint32_t* costs) {
+	for (int i = 0; i < vocabulary.size(); i++) {
+		PROFILE_ZONE("dtw");
+		costs[i] = dtwWorkspace.compare(vocabulary[i].frames, vocabulary[i].numFrames, word, wordLength);
+	}
+
+	uint32_t bestCost = std::numeric_limits<uint32_t>::max();
+	int bestIdx = -1;
+	for (int i = 0; i < vocabulary.size(); i++) {
+		if (bestCost >= costs[i]) {
+			bestCost = costs[i];
+			bestIdx = i;
+		}
+	}
+	return bestIdx;
+}
+
+// The output of the feature extractor for one block, all the word recognizer needs
+struct FeatureFrame {
+	WordSegmenter<maxWords>::Decision segment;
+	// Index of the first sample of the block
+	latency::SampleIndex blockStart = 0;
+	// End of the last loud frame up to this block
+	latency::SampleIndex lastLoudFrameEnd = 0;
+	// Whether featureVector was computed for this block
+	bool hasFeatures = false;
+	// Whether the front end's cepstrum was computed for this block
+	bool hasCepstrum = false;
+	FeatureVector featureVector;
+};
+
+/**
+ * The per-block half of a recognizer stream, from blocks of samples to
+ * feature frames. It has a fixed cost per block, so the firmware runs it in
+ * an interrupt and hands the frames to a WordRecognizer in thread mode.
+ */
+template<typename FrontEndType>
+class BasicFeatureExtractor {
+public:
+	using Segment = WordSegmenter<maxWords>::Decision;
+
+	void reset() {
+		front = FrontEndType();
+		wordSegmenter.reset();
+		current = FeatureFrame();
+	}
+
+	// Preprocesses a block of ADC samples starting at sample index blockStart
+	// and decides if it belongs to a word
+	Segment addBlock(const uint16_t* samples, latency::SampleIndex blockStart) {
+		return addBlock(samples, [](uint16_t sample) { return sample; }, blockStart);
+	}
+
+	// Like addBlock(), for samples that toAdc converts to ADC counts
+	template<typename Sample, typename ToAdc>
+	Segment addBlock(const Sample* samples, ToAdc toAdc, latency::SampleIndex blockStart) {
+		current.segment = wordSegmenter.update(front.addBlock(samples, toAdc));
+		if (current.segment.loud) {
+			current.lastLoudFrameEnd = blockStart + windowStride;
+		}
+		current.blockStart = blockStart;
+		current.hasFeatures = false;
+		current.hasCepstrum = false;
+		return current.segment;
+	}
+
+	// Computes the feature vector of the block if the word needs it, and with
+	// it the whole cepstrum if always is set. Returns whether they were computed.
+	bool computeFeatures(bool always) {
+		if (always) {
+			front.computeCepstrum();
+			PROFILE_ZONE("fvscl");
+			computeFeatureVector(front.cepstrum(), current.featureVector);
+			current.hasCepstrum = true;
+		}
+		else if (current.segment.storeFeatureVector) {
+			// Only the DCT rows of the feature vector
+			front.computeFeatureVector(current.featureVector);
+		}
+		else {
+			return false;
+		}
+		current.hasFeatures = true;
+		return true;
+	}
+
+	// The frame of the last block
+	const FeatureFrame& frame() const {
+		return current;
+	}
+
+	const FrontEndType& frontEnd() const {
+		return front;
+	}
+
+private:
+	FrontEndType front;
+	WordSegmenter<maxWords> wordSegmenter;
+	FeatureFrame current;
+};
+
+using FeatureExtractor = BasicFeatureExtractor<FrontEnd>;
+
+/**
+ * The per-word half of a recognizer stream, collects the feature frames of a
+ * word and compares it with the vocabulary. The vocabulary and the templates
+ * it points to are read-only and may be shared by many streams.
+ */
+template<typename VocabularyType>
+class WordRecognizer {
+public:
+	struct Result {
+		// Best matching vocabulary entry, -1 if the vocabulary is empty
+		int commandIdx = -1;
+		uint32_t cost = std::numeric_limits<uint32_t>::max();
+		int wordLength = 0;
+		// Start of the first frame of the word
+		latency::SampleIndex speechStart = 0;
+		// End of the last loud frame of the word
+		latency::SampleIndex speechEnd = 0;
+	};
+
+	explicit WordRecognizer(const VocabularyType& vocabulary) : vocabulary(vocabulary) {}
+
+	// Adds the frames in block order, returns whether the frame finished a word
+	bool addFrame(const FeatureFrame& frame) {
+		if (frame.segment.storeFeatureVector) {
+			wordBuffer[frame.segment.wordLength - 1] = frame.featureVector;
+			wordBufferSampleIndex[frame.segment.wordLength - 1] = frame.blockStart;
+		}
+		wordLength = frame.segment.wordLength;
+		lastLoudFrameEnd = frame.lastLoudFrameEnd;
+		return frame.segment.wordFinished;
+	}
+
+	// Compares the word finished by the last frame with the vocabulary
+	Result recognize() {
+		Result result;
+		result.commandIdx = findBestMatch(vocabulary, wordBuffer.data(), wordLength, dtwWorkspace, costs.data());
+		if (result.commandIdx >= 0) {
+			result.cost = costs[result.commandIdx];
+		}
+		result.wordLength = wordLength;
+		result.speechStart = wordBufferSampleIndex[0];
+		result.speechEnd = lastLoudFrameEnd;
+		return result;
+	}
+
+	// The frames of the word finished by the last frame
+	const FeatureVector* word() const {
+		return wordBuffer.data();
+	}
+
+	// DTW cost of every vocabulary entry for the last recognized word
+	uint32_t cost(int idx) const {
+		return costs[idx];
+	}
+
+private:
+	const VocabularyType& vocabulary;
+	int wordLength = 0;
+	latency::SampleIndex lastLoudFrameEnd = 0;
+	std::array<FeatureVector, maxWords> wordBuffer;
+	// Sample index of the block each wordBuffer entry was computed from
+	std::array<latency::SampleIndex, maxWords> wordBufferSampleIndex;
+	Dtw<Pipeline::dtwFrames, FeatureVector> dtwWorkspace;
+	std::array<uint32_t, VocabularyType::capacity> costs;
+};
+
+/**
+ * All state of one recognizer stream, from blocks of samples to words, for
+ * running both halves back to back.
+ *
+ * A block is processed in three steps, so callers can account for each of
+ * them: addBlock(), computeFeatures() and, once a word is finished,
+ * recognize().
+ */
+template<typename VocabularyType, typename FrontEndType = FrontEnd>
+class Recognizer {
+public:
+	using Segment = typename BasicFeatureExtractor<FrontEndType>::Segment;
+	using Result = typename WordRecognizer<VocabularyType>::Result;
+
+	explicit Recognizer(const VocabularyType& vocabulary) : words(vocabulary) {}
+
+	void reset() {
+		extractor.reset();
+	}
+
+	Segment addBlock(const uint16_t* samples, latency::SampleIndex blockStart) {
+		return extractor.addBlock(samples, blockStart);
+	}
+
+	template<typename Sample, typename ToAdc>
+	Segment addBlock(const Sample* samples, ToAdc toAdc, latency::SampleIndex blockStart) {
+		return extractor.addBlock(samples, toAdc, blockStart);
+	}
+
+	bool computeFeatures(bool always) {
+		const bool computed = extractor.computeFeatures(always);
+		words.addFrame(extractor.frame());
+		return computed;
+	}
+
+	Result recognize() {
+		return words.recognize();
+	}
+
+	const FrontEndType& frontEnd() const {
+		return extractor.frontEnd();
+	}
+
+	const FeatureVector* word() const {
+		return words.word();
+	}
+
+	uint32_t cost(int idx) const {
+		return words.cost(idx);
+	}
+
+private:
+	BasicFeatureExtractor<FrontEndType> extractor;
+	WordRecognizer<VocabularyType> words;
+};
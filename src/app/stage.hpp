@@ -0,0 +1,158 @@
+#pragma once
+#include <cstddef>
+#include <tuple>
+#include <type_traits>
+#include <utility>
+
+/**
+ * Composable processing stages with static dispatch.
+ *
+ * A stage declares the buffers it reads and writes and processes one into
+ * the other:
+ *
+ *     struct Stage {
+ *         using Input = std::array<float, 512>;
+ *         using Output = std::array<float, 16>;
+ *         void process(const Input& input, Output& output);
+ *     };
+ *
+ * A stage that takes its input by non-const reference may use it as scratch.
+ * A stage whose Output is its Input can instead work in place:
+ *
+ *     struct InPlaceStage {
+ *         using Input = std::array<float, 512>;
+ *         using Output = Input;
+ *         static constexpr bool inPlace = true;
+ *         void process(Output& data);
+ *     };
+ *
+ * Chain<Stages...> runs stages back to back and is a stage itself. It owns
+ * the buffers between them, one per stage that is not in place: an in-place
+ * stage works on the buffer before it, and stages followed only by in-place
+ * ones write straight to the caller's output, so inserting one costs no
+ * memory and no copy. Only a chain that starts in place copies its input.
+ * Everything is resolved at compile time, a chain compiles to the same calls
+ * as writing the stages out by hand.
+ */
+namespace stage {
+
+	template<typename Stage, typename = void>
+	struct IsInPlace : std::false_type {};
+
+	template<typename Stage>
+	struct IsInPlace<Stage, std::enable_if_t<Stage::inPlace>> : std::true_type {
+		static_assert(std::is_same_v<typename Stage::Input, typename Stage::Output>, "an in-place stage must output its input type");
+	};
+
+	template<typename Stage>
+	constexpr bool isInPlace = IsInPlace<Stage>::value;
+
+	template<typename... Stages>
+	class Chain {
+		static_assert(sizeof...(Stages) > 0);
+
+		template<size_t I>
+		using StageAt = std::tuple_element_t<I, std::tuple<Stages...>>;
+
+		static constexpr size_t numStages = sizeof...(Stages);
+
+		// Whether only in-place stages follow stage I, then it writes the chain's output
+		template<size_t I>
+		static constexpr bool writesOutput() {
+			if constexpr (I + 1 < numStages) {
+				return isInPlace<StageAt<I + 1>> && writesOutput<I + 1>();
+			}
+			else {
+				return true;
+			}
+		}
+
+		// Stage I needs a buffer of its own unless it is in place after another stage
+		template<size_t I>
+		static constexpr bool ownsBuffer = !writesOutput<I>() && !(isInPlace<StageAt<I>> && I > 0);
+
+		struct NoBuffer {};
+
+		template<size_t I>
+		using BufferAt = std::conditional_t<ownsBuffer<I>, typename StageAt<I>::Output, NoBuffer>;
+
+		template<size_t... I>
+		static auto bufferTuple(std::index_sequence<I...>) -> std::tuple<BufferAt<I>...>;
+
+		template<size_t I>
+		static constexpr bool consecutive() {
+			if constexpr (I + 1 < numStages) {
+				return std::is_same_v<typename StageAt<I>::Output, typename StageAt<I + 1>::Input> && consecutive<I + 1>();
+			}
+			else {
+				return true;
+			}
+		}
+		static_assert(consecutive<0>(), "each stage must take the output of the one before it");
+
+	public:
+		using Input = typename StageAt<0>::Input;
+		using Output = typename StageAt<numStages - 1>::Output;
+
+		void process(Input& input, Output& output) {
+			run<0>(input, output);
+		}
+
+		template<size_t I>
+		StageAt<I>& get() {
+			return std::get<I>(stages);
+		}
+
+		template<size_t I>
+		const StageAt<I>& get() const {
+			return std::get<I>(stages);
+		}
+
+		// The output of stage I from the last run, unless it went to the caller's buffer
+		template<size_t I>
+		const typename StageAt<I>::Output& output() const {
+			static_assert(!writesOutput<I>(), "the stage writes to the caller's buffer");
+			if constexpr (ownsBuffer<I>) {
+				return std::get<I>(buffers);
+			}
+			else {
+				return output<I - 1>();
+			}
+		}
+
+	private:
+		template<size_t I>
+		typename StageAt<I>::Output& destination(Output& output) {
+			if constexpr (writesOutput<I>()) {
+				return output;
+			}
+			else if constexpr (ownsBuffer<I>) {
+				return std::get<I>(buffers);
+			}
+			else {
+				return destination<I - 1>(output);
+			}
+		}
+
+		template<size_t I>
+		void run(typename StageAt<I>::Input& input, Output& output) {
+			auto& result = destination<I>(output);
+			if constexpr (isInPlace<StageAt<I>>) {
+				// Only a first stage in place works on a copy of the chain's input
+				if constexpr (I == 0) {
+					result = input;
+				}
+				std::get<I>(stages).process(result);
+			}
+			else {
+				std::get<I>(stages).process(input, result);
+			}
+			if constexpr (I + 1 < numStages) {
+				run<I + 1>(result, output);
+			}
+		}
+
+		std::tuple<Stages...> stages;
+		decltype(bufferTuple(std::index_sequence_for<Stages...>())) buffers;
+	};
+}
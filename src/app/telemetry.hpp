@@ -0,0 +1,240 @@
+#pragma once
+#include <array>
+#include <cstdint>
+#include <cstring>
+
+/**
+ * Runtime control of the telemetry printed over the serial port.
+ *
+ * Commands are single lines of text, terminated by '\n' or '\r':
+ *
+ *     on <stream>          start printing a stream every frame
+ *     off <stream>         stop printing a stream
+ *     every <stream> <n>   print a stream on every n-th frame (and enable it)
+ *     once <stream>        print a stream on the next frame only
+ *     upload <bytes>       receive a new template database (template_upload.hpp)
+ *     enroll <word>        store the next spoken word as a new template (enrollment.hpp)
+ *     forget <word>        delete all enrolled templates of a word
+ *
+ * <stream> is one of the names in streamNames, or "all".
+ *
+ * The parser does not touch any hardware, characters are fed in one at a
+ * time with receive(), so it can be driven from the UART or from a script.
+ */
+namespace telemetry {
+
+	enum class Stream : uint8_t {
+		Mfcc,
+		Raw,
+		Spectrum,
+		Stats,
+		Scores,
+		Profile,
+	};
+
+	constexpr int numStreams = 6;
+	constexpr const char* streamNames[numStreams] = { "mfcc", "raw", "spec", "stat", "score", "prof" };
+
+	enum class Result : uint8_t {
+		None,     // Line not complete yet
+		Ok,       // Command executed
+		Error,    // Line could not be parsed
+		Upload,   // Template upload requested, see uploadSize()
+		Enroll,   // Enrollment requested, see commandText()
+		Forget,   // Forgetting enrolled templates requested, see commandText()
+	};
+
+	class Control {
+	public:
+		Control() {
+			setEnabled(Stream::Mfcc, true);
+			setEnabled(Stream::Stats, true);
+			setEnabled(Stream::Scores, true);
+		}
+
+		// Feeds one received character, executes the command once the line is complete.
+		Result receive(char c) {
+			if (c == '\n' || c == '\r') {
+				if (lineLength == 0) return Result::None;
+				line[lineLength] = '\0';
+				lineLength = 0;
+				if (overflow) {
+					overflow = false;
+					return Result::Error;
+				}
+				return execute(line.data());
+			}
+			if (lineLength < maxLineLength) {
+				line[lineLength++] = c;
+			}
+			else {
+				overflow = true;
+			}
+			return Result::None;
+		}
+
+		// Decides whether a stream is printed on this occasion (a frame, or a
+		// stats period). Must be called exactly once per occasion and stream,
+		// since it advances the decimation counter.
+		bool due(Stream stream) {
+			StreamState& state = streams[static_cast<int>(stream)];
+			if (state.oneShot) {
+				state.oneShot = false;
+				state.counter = 0;
+				return true;
+			}
+			if (!state.enabled) return false;
+			state.counter += 1;
+			if (state.counter < state.decimation) return false;
+			state.counter = 0;
+			return true;
+		}
+
+		// Whether a stream may be printed soon, without advancing any counters.
+		// Used to skip work that only feeds the telemetry.
+		bool wanted(Stream stream) const {
+			const StreamState& state = streams[static_cast<int>(stream)];
+			return state.oneShot || state.enabled;
+		}
+
+		void setEnabled(Stream stream, bool enabled) {
+			StreamState& state = streams[static_cast<int>(stream)];
+			state.enabled = enabled;
+			state.counter = 0;
+		}
+
+		void setDecimation(Stream stream, uint16_t decimation) {
+			StreamState& state = streams[static_cast<int>(stream)];
+			state.decimation = (decimation > 0) ? decimation : 1;
+			state.counter = 0;
+		}
+
+		void requestOnce(Stream stream) {
+			streams[static_cast<int>(stream)].oneShot = true;
+		}
+
+		// Size in bytes of the last requested upload
+		uint32_t uploadSize() const {
+			return requestedUploadSize;
+		}
+
+		// Word of the last enroll or forget command
+		const char* commandText() const {
+			return requestedText.data();
+		}
+
+	private:
+		static constexpr int maxLineLength = 31;
+		static constexpr int maxTextLength = 15;
+		static constexpr int allStreams = -1;
+
+		struct StreamState {
+			bool enabled = false;
+			bool oneShot = false;
+			uint16_t decimation = 1;
+			uint16_t counter = 0;
+		};
+
+		std::array<StreamState, numStreams> streams;
+		std::array<char, maxLineLength + 1> line;
+		int lineLength = 0;
+		bool overflow = false;
+		uint32_t requestedUploadSize = 0;
+		std::array<char, maxTextLength + 1> requestedText = {};
+
+		Result execute(char* text) {
+			char* command = nextToken(text);
+			char* streamName = nextToken(text);
+			char* argument = nextToken(text);
+			if (command == nullptr || streamName == nullptr || nextToken(text) != nullptr) return Result::Error;
+
+			if (std::strcmp(command, "upload") == 0) {
+				if (argument != nullptr || !parseNumber(streamName, requestedUploadSize)) return Result::Error;
+				return Result::Upload;
+			}
+
+			if (std::strcmp(command, "enroll") == 0 || std::strcmp(command, "forget") == 0) {
+				if (argument != nullptr || std::strlen(streamName) > maxTextLength) return Result::Error;
+				std::strcpy(requestedText.data(), streamName);
+				return (command[0] == 'e') ? Result::Enroll : Result::Forget;
+			}
+
+			int streamIdx;
+			if (!parseStream(streamName, streamIdx)) return Result::Error;
+
+			if (std::strcmp(command, "every") == 0) {
+				uint32_t decimation;
+				if (argument == nullptr || !parseNumber(argument, decimation) || decimation > UINT16_MAX) return Result::Error;
+				forEachStream(streamIdx, [&](Stream s) {
+					setDecimation(s, decimation);
+					setEnabled(s, true);
+				});
+				return Result::Ok;
+			}
+
+			if (argument != nullptr) return Result::Error;
+
+			if (std::strcmp(command, "on") == 0) {
+				forEachStream(streamIdx, [&](Stream s) { setEnabled(s, true); });
+			}
+			else if (std::strcmp(command, "off") == 0) {
+				forEachStream(streamIdx, [&](Stream s) { setEnabled(s, false); });
+			}
+			else if (std::strcmp(command, "once") == 0) {
+				forEachStream(streamIdx, [&](Stream s) { requestOnce(s); });
+			}
+			else {
+				return Result::Error;
+			}
+			return Result::Ok;
+		}
+
+		template<typename Function>
+		void forEachStream(int streamIdx, Function function) {
+			if (streamIdx == allStreams) {
+				for (int i = 0; i < numStreams; i++) {
+					function(static_cast<Stream>(i));
+				}
+			}
+			else {
+				function(static_cast<Stream>(streamIdx));
+			}
+		}
+
+		// Splits off the next space-separated token, advancing text past it.
+		static char* nextToken(char*& text) {
+			while (*text == ' ') text++;
+			if (*text == '\0') return nullptr;
+			char* token = text;
+			while (*text != ' ' && *text != '\0') text++;
+			if (*text == ' ') *text++ = '\0';
+			return token;
+		}
+
+		static bool parseStream(const char* name, int& streamIdx) {
+			if (std::strcmp(name, "all") == 0) {
+				streamIdx = allStreams;
+				return true;
+			}
+			for (int i = 0; i < numStreams; i++) {
+				if (std::strcmp(name, streamNames[i]) == 0) {
+					streamIdx = i;
+					return true;
+				}
+			}
+			return false;
+		}
+
+		static bool parseNumber(const char* text, uint32_t& value) {
+			uint32_t result = 0;
+			for (; *text != '\0'; text++) {
+				if (*text < '0' || *text > '9') return false;
+				const uint32_t digit = *text - '0';
+				if (result > (UINT32_MAX - digit) / 10) return false;
+				result = result * 10 + digit;
+			}
+			value = result;
+			return true;
+		}
+	};
+}
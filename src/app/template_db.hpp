@@ -0,0 +1,164 @@
+#pragma once
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+
+/**
+ * Binary template database, read in place from flash or a memory-mapped file.
+ *
+ * Layout, little endian, all offsets relative to the start of the database:
+ *
+ *     Header                      32 bytes
+ *     TemplateInfo[numTemplates]  24 bytes each
+ *     frames                      numFrames * featureVectorDim floats per template,
+ *                                 starting at frameOffset, 4-byte aligned
+ *
+ * The checksum is the CRC-32 (as in zlib) of everything after the header,
+ * up to totalSize. The database is written by the template_builder host tool.
+ */
+namespace templatedb {
+
+	constexpr uint32_t magic = 0x4454504c; // "LPTD"
+	constexpr uint16_t version = 1;
+	constexpr int maxTextLength = 15;
+
+	struct Header {
+		uint32_t magic;
+		uint16_t version;
+		uint16_t featureVectorDim;
+		uint32_t numTemplates;
+		uint32_t totalSize;
+		uint32_t checksum;
+		uint32_t reserved[3];
+	};
+	static_assert(sizeof(Header) == 32);
+
+	struct TemplateInfo {
+		char text[maxTextLength + 1];
+		uint32_t frameOffset;
+		uint32_t numFrames;
+	};
+	static_assert(sizeof(TemplateInfo) == 24);
+
+	enum class Error : uint8_t {
+		None,
+		TooSmall,
+		BadMagic,
+		BadVersion,
+		BadChecksum,
+		BadTemplate,
+		// The database is valid, but does not fit this build of the recognizer
+		Incompatible,
+	};
+
+	constexpr const char* errorNames[] = { "none", "too small", "bad magic", "bad version", "bad checksum", "bad template", "incompatible" };
+
+	inline const char* errorName(Error error) {
+		return errorNames[static_cast<int>(error)];
+	}
+
+	// CRC-32 with the zlib polynomial, continues from a previous crc
+	inline uint32_t crc32(const uint8_t* data, size_t size, uint32_t crc = 0) {
+		crc = ~crc;
+		for (size_t i = 0; i < size; i++) {
+			crc ^= data[i];
+			for (int bit = 0; bit < 8; bit++) {
+				crc = (crc >> 1) ^ (0xedb88320 & -(crc & 1));
+			}
+		}
+		return ~crc;
+	}
+
+	// Read-only view of a database, does not copy anything
+	class Database {
+	public:
+		// Checks the structure of the database, the view is empty unless it is valid
+		Error open(const void* data, size_t size) {
+			close();
+			const uint8_t* bytes = static_cast<const uint8_t*>(data);
+			if (size < sizeof(Header) || reinterpret_cast<uintptr_t>(bytes) % alignof(Header) != 0) return Error::TooSmall;
+
+			const Header* header = reinterpret_cast<const Header*>(bytes);
+			if (header->magic != magic) return Error::BadMagic;
+			if (header->version != version) return Error::BadVersion;
+			if (header->totalSize > size || header->totalSize < sizeof(Header)) return Error::TooSmall;
+			// In 64 bits, so a crafted count cannot wrap a 32 bit size_t
+			const uint64_t tableEnd = sizeof(Header) + uint64_t(header->numTemplates) * sizeof(TemplateInfo);
+			if (tableEnd > header->totalSize) return Error::TooSmall;
+			if (header->featureVectorDim == 0) return Error::BadTemplate;
+
+			const uint8_t* body = bytes + sizeof(Header);
+			if (crc32(body, header->totalSize - sizeof(Header)) != header->checksum) return Error::BadChecksum;
+
+			const TemplateInfo* table = reinterpret_cast<const TemplateInfo*>(body);
+			const uint64_t frameSize = uint64_t(header->featureVectorDim) * sizeof(float);
+			for (uint32_t i = 0; i < header->numTemplates; i++) {
+				const TemplateInfo& info = table[i];
+				if (std::memchr(info.text, '\0', sizeof(info.text)) == nullptr) return Error::BadTemplate;
+				if (info.frameOffset % alignof(float) != 0 || info.frameOffset < tableEnd || info.frameOffset > header->totalSize) {
+					return Error::BadTemplate;
+				}
+				const uint64_t framesEnd = info.frameOffset + uint64_t(info.numFrames) * frameSize;
+				if (info.numFrames == 0 || framesEnd > header->totalSize) return Error::BadTemplate;
+			}
+
+			this->bytes = bytes;
+			this->header = header;
+			this->table = table;
+			return Error::None;
+		}
+
+		// Checks that the templates fit the recognizer's buffers
+		Error check(int featureVectorDim, int maxTemplates, int maxFrames) const {
+			if (header == nullptr) return Error::TooSmall;
+			if (header->featureVectorDim != featureVectorDim || size() > maxTemplates) return Error::Incompatible;
+			for (int i = 0; i < size(); i++) {
+				if (numFrames(i) > maxFrames) return Error::Incompatible;
+			}
+			return Error::None;
+		}
+
+		void close() {
+			bytes = nullptr;
+			header = nullptr;
+			table = nullptr;
+		}
+
+		bool isOpen() const {
+			return header != nullptr;
+		}
+
+		int size() const {
+			return (header != nullptr) ? header->numTemplates : 0;
+		}
+
+		int featureVectorDim() const {
+			return header->featureVectorDim;
+		}
+
+		uint32_t totalSize() const {
+			return header->totalSize;
+		}
+
+		const char* text(int idx) const {
+			return table[idx].text;
+		}
+
+		int numFrames(int idx) const {
+			return table[idx].numFrames;
+		}
+
+		// The frames of a template as feature vectors, Dim must match featureVectorDim()
+		template<int Dim>
+		const std::array<float, Dim>* frames(int idx) const {
+			static_assert(sizeof(std::array<float, Dim>) == Dim * sizeof(float));
+			return reinterpret_cast<const std::array<float, Dim>*>(bytes + table[idx].frameOffset);
+		}
+
+	private:
+		const uint8_t* bytes = nullptr;
+		const Header* header = nullptr;
+		const TemplateInfo* table = nullptr;
+	};
+}
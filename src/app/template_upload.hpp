@@ -0,0 +1,77 @@
+#pragma once
+#include <cstdint>
+
+/**
+ * Receives a new template database over the serial port and writes it to flash.
+ *
+ * After the "upload <bytes>" command the storage is erased and the firmware
+ * answers "msg:upload: ready". The host then sends the raw database in chunks
+ * of chunkSize bytes, waiting for the "msg:upload: <received>" acknowledgment
+ * after each one, since the UART receive buffer is small. Once all bytes are
+ * written the database is validated and the recognizer switches to it. See
+ * scripts/upload_templates.py.
+ *
+ * Storage must provide size(), erase() and program(offset, word) like flash::Region.
+ */
+template<typename Storage>
+class TemplateUpload {
+public:
+	static constexpr uint32_t chunkSize = 128;
+
+	enum class Status : uint8_t {
+		Receiving,
+		ChunkComplete,  // Acknowledge the chunk
+		Complete,       // All bytes written
+		Failed,         // Flash write failed, upload aborted
+	};
+
+	explicit TemplateUpload(Storage& storage) : storage(storage) {}
+
+	// Erases the storage, returns false if the size does not fit or erasing failed
+	bool begin(uint32_t size) {
+		active = false;
+		if (size == 0 || size > storage.size()) return false;
+		if (!storage.erase()) return false;
+		expected = size;
+		received = 0;
+		word = 0;
+		active = true;
+		return true;
+	}
+
+	Status receive(uint8_t byte) {
+		word |= uint32_t(byte) << (8 * (received % 4));
+		received += 1;
+		if (received % 4 == 0 || received == expected) {
+			if (!storage.program((received - 1) & ~3u, word)) {
+				active = false;
+				return Status::Failed;
+			}
+			word = 0;
+		}
+		if (received == expected) {
+			active = false;
+			return Status::Complete;
+		}
+		return (received % chunkSize == 0) ? Status::ChunkComplete : Status::Receiving;
+	}
+
+	void abort() {
+		active = false;
+	}
+
+	bool isActive() const {
+		return active;
+	}
+
+	uint32_t bytesReceived() const {
+		return received;
+	}
+
+private:
+	Storage& storage;
+	bool active = false;
+	uint32_t expected = 0;
+	uint32_t received = 0;
+	uint32_t word = 0;
+};
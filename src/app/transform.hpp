@@ -4,8 +4,12 @@
 
 #include <gcem.hpp>
 
+#include "arm_math.h"
+
 #include <common/utils.hpp>
 
+#include "fft_plan.hpp"
+
 template<int N, typename T = float>
 class HannWindow {
 	static_assert(isPowerOf2(N));
@@ -29,29 +33,96 @@ private:
 	static constexpr double pi = 3.14159265358979323846;
 };
 
-HannWindow<512> windowTable;
-
-template<int N, typename T = float>
+// Orthonormal DCT-II as a matrix, only the rows of coefficients First to
+// Last - 1, so a caller that needs a few coefficients stores and computes
+// only those
+template<int N, int First = 0, int Last = N, typename T = float>
 class DiscreteCosineTransformTable {
+	static_assert(0 <= First && First < Last && Last <= N);
+
 public:
+	static constexpr int firstCoefficient = First;
+	static constexpr int lastCoefficient = Last;
+	static constexpr int numCoefficients = Last - First;
+
 	constexpr DiscreteCosineTransformTable() : lut() {
-		for (int k = 0; k < N; k++) {
+		for (int k = First; k < Last; k++) {
 			for (int n = 0; n < N; n++) {
 				double x = gcem::cos(pi / N * (n + 0.5) * k);
 				double scaling = gcem::sqrt(2.0 / N) * ((k == 0) ? gcem::sqrt(0.5) : 1);
-				lut[k * N + n] = static_cast<T>(x * scaling);
+				lut[(k - First) * N + n] = static_cast<T>(x * scaling);
 			}
 		}
 	}
 
+	// Coefficient k, First <= k < Last
 	constexpr T evaluate(const std::array<T, N>& x, int k) const {
 		T result = 0.0;
 		for (int n = 0; n < N; n++) {
-			result += x[n] * lut[k * N + n];
+			result += x[n] * lut[(k - First) * N + n];
 		}
 		return result;
 	}
+
 private:
-	std::array<T, N * N> lut;
+	std::array<T, numCoefficients * N> lut;
 	static constexpr double pi = 3.14159265358979323846;
-};
\ No newline at end of file
+};
+
+/**
+ * The orthonormal DCT-II of all N coefficients in O(N log N), for larger
+ * filterbanks where the O(N^2) table costs more than an FFT. Uses Makhoul's
+ * algorithm: the even samples in order followed by the odd ones reversed go
+ * through an N point real FFT, and a twiddle factor per coefficient turns its
+ * output into the DCT. Same results as DiscreteCosineTransformTable up to
+ * rounding.
+ *
+ * arm_rfft_fast_f32 limits N to powers of two from 32 to 4096.
+ */
+template<int N>
+class FastDctII {
+	static_assert(isPowerOf2(N) && N >= 32 && N <= 4096);
+
+public:
+	void evaluate(const std::array<float, N>& x, std::array<float, N>& result) {
+		for (int n = 0; n < N / 2; n++) {
+			reordered[n] = x[2 * n];
+			reordered[N - 1 - n] = x[2 * n + 1];
+		}
+		arm_rfft_fast_f32(&fftSettings, reordered.data(), spectrum.data(), 0);
+
+		// The real FFT packs the real parts of bins 0 and N / 2 into its first
+		// two values, bins above N / 2 are the complex conjugates of those below
+		result[0] = spectrum[0] * twiddles.cosine[0];
+		result[N / 2] = spectrum[1] * twiddles.cosine[N / 2];
+		for (int k = 1; k < N / 2; k++) {
+			const float real = spectrum[2 * k];
+			const float imag = spectrum[2 * k + 1];
+			result[k] = real * twiddles.cosine[k] + imag * twiddles.sine[k];
+			result[N - k] = real * twiddles.cosine[N - k] - imag * twiddles.sine[N - k];
+		}
+	}
+
+private:
+	// exp(-i pi k / 2N) with the orthonormal scaling of coefficient k
+	struct Twiddles {
+		std::array<float, N> cosine;
+		std::array<float, N> sine;
+
+		constexpr Twiddles() : cosine(), sine() {
+			for (int k = 0; k < N; k++) {
+				double scaling = gcem::sqrt(2.0 / N) * ((k == 0) ? gcem::sqrt(0.5) : 1);
+				cosine[k] = static_cast<float>(gcem::cos(pi * k / (2 * N)) * scaling);
+				sine[k] = static_cast<float>(gcem::sin(pi * k / (2 * N)) * scaling);
+			}
+		}
+	};
+
+	static constexpr double pi = 3.14159265358979323846;
+	static constexpr Twiddles twiddles{};
+	static constexpr fft::RealPlan<N> plan{};
+
+	arm_rfft_fast_instance_f32 fftSettings = plan.settings();
+	std::array<float, N> reordered;
+	std::array<float, N> spectrum;
+};
@@ -0,0 +1,42 @@
+#pragma once
+#include <array>
+
+/**
+ * Index of everything the recognizer compares a word against: the templates
+ * from the database and the enrolled ones. Only pointers are stored, the
+ * frames stay in flash. Rebuild it whenever one of the sources changes.
+ */
+template<typename FeatureVector, int MaxEntries>
+class Vocabulary {
+public:
+	static constexpr int capacity = MaxEntries;
+
+	struct Entry {
+		const char* text;
+		const FeatureVector* frames;
+		int numFrames;
+	};
+
+	void clear() {
+		count = 0;
+	}
+
+	// Returns false if the vocabulary is full
+	bool add(const char* text, const FeatureVector* frames, int numFrames) {
+		if (count == MaxEntries) return false;
+		entries[count++] = Entry{ text, frames, numFrames };
+		return true;
+	}
+
+	int size() const {
+		return count;
+	}
+
+	const Entry& operator[](int idx) const {
+		return entries[idx];
+	}
+
+private:
+	std::array<Entry, MaxEntries> entries;
+	int count = 0;
+};
@@ -0,0 +1,71 @@
+#pragma once
+
+/**
+ * Decides from the RMS amplitude of each frame where spoken words start and end.
+ *
+ * A word starts with the first frame above the amplitude threshold and ends
+ * after maxQuietGap consecutive quiet frames; the quiet tail is not part of
+ * the word. Words shorter than minWordLength frames are discarded, words
+ * longer than MaxWordLength frames are truncated.
+ *
+ * This is the one place these rules live, the firmware and the host tools
+ * both segment with it.
+ */
+template<int MaxWordLength>
+class WordSegmenter {
+public:
+	static constexpr int maxQuietGap = 7;
+	static constexpr int minWordLength = 5;
+	static constexpr float amplitudeThreshold = 0.01f;
+
+	struct Decision {
+		// The frame is above the amplitude threshold
+		bool loud = false;
+		// The feature vector of this frame belongs to the current word, at index wordLength - 1
+		bool storeFeatureVector = false;
+		// The current word ended on this frame, it is wordLength frames long
+		bool wordFinished = false;
+		int wordLength = 0;
+	};
+
+	Decision update(float rmsAmplitude) {
+		Decision decision;
+		decision.loud = rmsAmplitude > amplitudeThreshold;
+
+		if (decision.loud) {
+			wordLength += 1;
+			quietGapCounter = maxQuietGap;
+		}
+		else if (wordLength > 0) {
+			quietGapCounter -= 1;
+			wordLength += 1;
+			if (quietGapCounter == 0) {
+				int spokenLength = wordLength - maxQuietGap;
+				reset();
+				if (spokenLength >= minWordLength) {
+					decision.wordFinished = true;
+					decision.wordLength = (spokenLength < MaxWordLength) ? spokenLength : MaxWordLength;
+				}
+				return decision;
+			}
+		}
+
+		decision.wordLength = (wordLength < MaxWordLength) ? wordLength : MaxWordLength;
+		decision.storeFeatureVector = wordLength > 0 && wordLength <= MaxWordLength;
+		return decision;
+	}
+
+	void reset() {
+		wordLength = 0;
+		quietGapCounter = 0;
+	}
+
+	// Number of frames since the current word started, 0 between words
+	int currentLength() const {
+		return wordLength;
+	}
+
+private:
+	int wordLength = 0;
+	int quietGapCounter = 0;
+};
@@ -0,0 +1,219 @@
+#pragma once
+#include <algorithm>
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <new>
+#include <tuple>
+#include <type_traits>
+
+#if !defined(__arm__)
+#include <cstdio>
+#include <cstdlib>
+#endif
+
+/**
+ * Buffers that share one block of static memory where their lifetimes allow.
+ *
+ * A Plan lists the buffers with the steps they are live in, from the step
+ * that writes one to the last step that reads it:
+ *
+ *     using FramePlan = arena::Plan<
+ *         arena::Buffer<Samples, 0, 1>,
+ *         arena::Buffer<Spectrum, 1, 3>,
+ *         arena::Buffer<MelPower, 2, 3>>;
+ *
+ * and places them at compile time, first fit in the order they are listed.
+ * A buffer shares bytes only with buffers that are never live at the same
+ * step, here MelPower with Samples. Plan::size is the peak footprint and
+ * Plan::separateSize what the buffers would take on their own.
+ *
+ * An Arena<Plan> is the memory. begin<I>() starts the lifetime of buffer I
+ * for writing it, get<I>() views it. On the target that is all, the host
+ * build also tracks which buffers are live and aborts when a buffer is
+ * viewed after another one reused its bytes.
+ */
+namespace arena {
+
+	// A buffer of a Type, live from FirstStep to LastStep
+	template<typename T, int FirstStep, int LastStep>
+	struct Buffer {
+		using Type = T;
+		static constexpr int firstStep = FirstStep;
+		static constexpr int lastStep = LastStep;
+
+		static_assert(FirstStep <= LastStep);
+		static_assert(std::is_trivially_copyable_v<T> && std::is_trivially_destructible_v<T>,
+			"buffers are reused without being constructed or destroyed");
+	};
+
+	namespace detail {
+		template<size_t N>
+		struct Layout {
+			std::array<size_t, N> sizes;
+			std::array<size_t, N> alignments;
+			std::array<int, N> firstSteps;
+			std::array<int, N> lastSteps;
+
+			constexpr bool liveTogether(size_t i, size_t j) const {
+				return firstSteps[i] <= lastSteps[j] && firstSteps[j] <= lastSteps[i];
+			}
+		};
+
+		constexpr size_t alignUp(size_t offset, size_t alignment) {
+			return (offset + alignment - 1) / alignment * alignment;
+		}
+
+		// Each buffer at the lowest offset, the start or the end of one placed
+		// before it, where it is clear of all placed buffers live with it
+		template<size_t N>
+		constexpr std::array<size_t, N> place(const Layout<N>& layout) {
+			std::array<size_t, N> offsets = {};
+			for (size_t i = 0; i < N; i++) {
+				size_t best = SIZE_MAX;
+				for (size_t c = 0; c <= i; c++) {
+					const size_t candidate = alignUp(c < i ? offsets[c] + layout.sizes[c] : 0, layout.alignments[i]);
+					bool clear = true;
+					for (size_t j = 0; j < i; j++) {
+						const bool disjoint = candidate + layout.sizes[i] <= offsets[j] || offsets[j] + layout.sizes[j] <= candidate;
+						clear = clear && (disjoint || !layout.liveTogether(i, j));
+					}
+					if (clear && candidate < best) {
+						best = candidate;
+					}
+				}
+				offsets[i] = best;
+			}
+			return offsets;
+		}
+
+		template<size_t N>
+		constexpr size_t end(const Layout<N>& layout, const std::array<size_t, N>& offsets) {
+			size_t result = 0;
+			for (size_t i = 0; i < N; i++) {
+				result = std::max(result, offsets[i] + layout.sizes[i]);
+			}
+			return result;
+		}
+
+		// No two buffers live at the same step share a byte
+		template<size_t N>
+		constexpr bool separateWhileLive(const Layout<N>& layout, const std::array<size_t, N>& offsets) {
+			bool separate = true;
+			for (size_t i = 0; i < N; i++) {
+				for (size_t j = 0; j < i; j++) {
+					const bool disjoint = offsets[i] + layout.sizes[i] <= offsets[j] || offsets[j] + layout.sizes[j] <= offsets[i];
+					separate = separate && (disjoint || !layout.liveTogether(i, j));
+				}
+			}
+			return separate;
+		}
+
+		template<size_t N>
+		constexpr size_t sum(const std::array<size_t, N>& values) {
+			size_t result = 0;
+			for (size_t value : values) {
+				result += value;
+			}
+			return result;
+		}
+
+		template<size_t N>
+		constexpr size_t max(const std::array<size_t, N>& values) {
+			size_t result = 0;
+			for (size_t value : values) {
+				result = std::max(result, value);
+			}
+			return result;
+		}
+	}
+
+	template<typename... Buffers>
+	class Plan {
+		static constexpr detail::Layout<sizeof...(Buffers)> layout = {
+			{ sizeof(typename Buffers::Type)... },
+			{ alignof(typename Buffers::Type)... },
+			{ Buffers::firstStep... },
+			{ Buffers::lastStep... },
+		};
+
+	public:
+		static constexpr size_t numBuffers = sizeof...(Buffers);
+
+		template<size_t I>
+		using TypeAt = typename std::tuple_element_t<I, std::tuple<Buffers...>>::Type;
+
+		static constexpr std::array<size_t, numBuffers> offsets = detail::place(layout);
+		static constexpr size_t size = detail::end(layout, offsets);
+		static constexpr size_t separateSize = detail::sum(layout.sizes);
+		static constexpr size_t alignment = detail::max(layout.alignments);
+
+		static constexpr size_t bufferSize(size_t i) {
+			return layout.sizes[i];
+		}
+
+		static constexpr int firstStep(size_t i) {
+			return layout.firstSteps[i];
+		}
+
+		static constexpr int lastStep(size_t i) {
+			return layout.lastSteps[i];
+		}
+
+		static constexpr bool shareBytes(size_t i, size_t j) {
+			return offsets[i] < offsets[j] + layout.sizes[j] && offsets[j] < offsets[i] + layout.sizes[i];
+		}
+
+		static_assert(numBuffers > 0);
+		static_assert(detail::separateWhileLive(layout, offsets));
+	};
+
+	template<typename PlanType>
+	class Arena {
+	public:
+		using Plan = PlanType;
+
+		template<size_t I>
+		using TypeAt = typename Plan::template TypeAt<I>;
+
+		// Starts the lifetime of buffer I, ending that of the buffers sharing its
+		// bytes. Its contents are undefined until written.
+		template<size_t I>
+		TypeAt<I>& begin() {
+#if !defined(__arm__)
+			for (size_t j = 0; j < Plan::numBuffers; j++) {
+				live[j] = live[j] && !Plan::shareBytes(I, j);
+			}
+			live[I] = true;
+#endif
+			return *new (storage + Plan::offsets[I]) TypeAt<I>;
+		}
+
+		template<size_t I>
+		TypeAt<I>& get() {
+			check(I);
+			return *std::launder(reinterpret_cast<TypeAt<I>*>(storage + Plan::offsets[I]));
+		}
+
+		template<size_t I>
+		const TypeAt<I>& get() const {
+			check(I);
+			return *std::launder(reinterpret_cast<const TypeAt<I>*>(storage + Plan::offsets[I]));
+		}
+
+	private:
+		void check([[maybe_unused]] size_t i) const {
+#if !defined(__arm__)
+			if (!live[i]) {
+				std::fprintf(stderr, "arena: buffer %zu read while not live, its memory was reused or never written\n", i);
+				std::abort();
+			}
+#endif
+		}
+
+		alignas(Plan::alignment) std::byte storage[Plan::size];
+#if !defined(__arm__)
+		std::array<bool, Plan::numBuffers> live = {};
+#endif
+	};
+}
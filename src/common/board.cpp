@@ -8,7 +8,8 @@ modm::log::Logger modm::log::info(serialDevice);
 modm::log::Logger modm::log::warning(serialDevice);
 modm::log::Logger modm::log::error(serialDevice);
 
-modm::log::Logger serOut(serialDevice);
+// Telemetry is printed every frame, so use the cheaper fixed-point float formatting
+modm::log::Logger serOut(serialDevice, modm::IOStream::FloatFormat::Fixed, 5);
 
 using namespace modm::literals;
 
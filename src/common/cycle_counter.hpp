@@ -0,0 +1,47 @@
+#pragma once
+#include <cstdint>
+
+#if defined(__arm__)
+#include <modm/platform/device.hpp>
+#include <common/board.hpp>
+#else
+#include <chrono>
+#endif
+
+/**
+ * Free-running cycle counter for fine-grained timing.
+ *
+ * On the target this is the Cortex-M4 DWT cycle counter, which counts core
+ * clock cycles. On the host it counts nanoseconds of a steady clock.
+ * The counter wraps around, so only differences between readings are meaningful.
+ */
+namespace cycleCounter {
+
+#if defined(__arm__)
+
+constexpr uint32_t frequency = ClockConfiguration::Frequency;
+
+inline void init() {
+	CoreDebug->DEMCR |= CoreDebug_DEMCR_TRCENA_Msk;
+	DWT->CYCCNT = 0;
+	DWT->CTRL |= DWT_CTRL_CYCCNTENA_Msk;
+}
+
+inline uint32_t now() {
+	return DWT->CYCCNT;
+}
+
+#else
+
+constexpr uint32_t frequency = 1'000'000'000;
+
+inline void init() {}
+
+inline uint32_t now() {
+	using namespace std::chrono;
+	return static_cast<uint32_t>(duration_cast<nanoseconds>(steady_clock::now().time_since_epoch()).count());
+}
+
+#endif
+
+}
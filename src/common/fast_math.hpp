@@ -0,0 +1,130 @@
+#pragma once
+#include <array>
+#include <cstdint>
+#include <cstring>
+
+/**
+ * Approximations of log2, log and sqrt for the feature pipeline.
+ *
+ * log2(x) splits x into its exponent e and mantissa 1 + t, t in [0, 1), by
+ * reinterpreting its bits, and evaluates a minimax polynomial for log2(1 + t).
+ * There are no branches or tables, so loops over arrays vectorize. The degree
+ * of the polynomial trades time for accuracy, Log2Polynomial<Degree>::maxError
+ * bounds the absolute error for x in [1, 2); elsewhere the rounding of e + p(t)
+ * adds at most half an ulp of the result. The fast_log2_test host test
+ * checks the bounds for every normal float.
+ *
+ * x must be positive and normal. 0 and denormals give about -127 instead of
+ * -infinity or their logarithm, which is harmless for energies.
+ *
+ * log2Q16() is the same approximation in integer arithmetic, for fixed point
+ * samples or energies.
+ */
+namespace fastmath {
+
+	// Minimax coefficients c1..cDegree of log2(1 + t) = c1 t + ... + cDegree t^Degree on [0, 1)
+	template<int Degree>
+	struct Log2Polynomial;
+
+	template<>
+	struct Log2Polynomial<3> {
+		static constexpr double coefficients[] = { 1.4245938771697608, -0.5892067128235597, 0.1653837867697462 };
+		static constexpr float maxError = 7.8e-4f;
+	};
+
+	template<>
+	struct Log2Polynomial<4> {
+		static constexpr double coefficients[] = { 1.4390146996904059, -0.6799441618241923, 0.3255958683822953, -0.08476874396947975 };
+		static constexpr float maxError = 1.1e-4f;
+	};
+
+	template<>
+	struct Log2Polynomial<5> {
+		static constexpr double coefficients[] = { 1.4419656175182443, -0.7096628291385514, 0.41759580460270723,
+			-0.19626965970217763, 0.04638536892430878 };
+		static constexpr float maxError = 1.5e-5f;
+	};
+
+	template<>
+	struct Log2Polynomial<6> {
+		static constexpr double coefficients[] = { 1.442553145025816, -0.7182819191034849, 0.4582708069395119,
+			-0.27953814033634383, 0.12345148873899803, -0.026457450005648947 };
+		static constexpr float maxError = 2.5e-6f;
+	};
+
+	template<>
+	struct Log2Polynomial<7> {
+		static constexpr double coefficients[] = { 1.4426678292138675, -0.7205854689620662, 0.4735534116452388,
+			-0.3259019744790326, 0.19429432319236462, -0.07955773132329148, 0.015529917392010137 };
+		static constexpr float maxError = 6e-7f;
+	};
+
+	// The coefficients as float for log2()
+	template<int Degree>
+	constexpr std::array<float, Degree> log2Coefficients() {
+		std::array<float, Degree> coefficients = {};
+		for (int i = 0; i < Degree; i++) {
+			coefficients[i] = float(Log2Polynomial<Degree>::coefficients[i]);
+		}
+		return coefficients;
+	}
+
+	// The coefficients in Q30 for log2Q16()
+	template<int Degree>
+	constexpr std::array<int64_t, Degree> log2CoefficientsQ30() {
+		std::array<int64_t, Degree> coefficients = {};
+		for (int i = 0; i < Degree; i++) {
+			const double scaled = Log2Polynomial<Degree>::coefficients[i] * (1 << 30);
+			coefficients[i] = int64_t(scaled < 0 ? scaled - 0.5 : scaled + 0.5);
+		}
+		return coefficients;
+	}
+
+	constexpr float ln2 = 0.69314718055994531f;
+
+	template<int Degree = 5>
+	inline float log2(float x) {
+		constexpr std::array<float, Degree> c = log2Coefficients<Degree>();
+		uint32_t bits;
+		std::memcpy(&bits, &x, sizeof(bits));
+		const float exponent = float(int32_t(bits >> 23) - 127);
+		// Same mantissa with exponent 0 is 1 + t
+		const uint32_t mantissaBits = (bits & 0x007fffff) | 0x3f800000;
+		float mantissa;
+		std::memcpy(&mantissa, &mantissaBits, sizeof(mantissa));
+		const float t = mantissa - 1.0f;
+
+		float p = c[Degree - 1];
+		for (int i = Degree - 2; i >= 0; i--) {
+			p = p * t + c[i];
+		}
+		return exponent + p * t;
+	}
+
+	// Natural logarithm, the error bounds of log2() times ln 2
+	template<int Degree = 5>
+	inline float log(float x) {
+		return log2<Degree>(x) * ln2;
+	}
+
+	// Exact, the FPU's square root instruction (VSQRT on the Cortex-M4F) for x >= 0
+	inline float sqrt(float x) {
+		return __builtin_sqrtf(x);
+	}
+
+	// log2(x) in Q16.16 for x > 0, from the integer part and the same polynomial
+	// in Q30. The result is within maxError + 2^-16 of the exact value.
+	template<int Degree = 5>
+	inline int32_t log2Q16(uint32_t x) {
+		constexpr std::array<int64_t, Degree> c = log2CoefficientsQ30<Degree>();
+		const int exponent = 31 - __builtin_clz(x);
+		// Bits below the leading one as t in Q30
+		const int64_t t = int64_t((x << (31 - exponent)) & 0x7fffffff) >> 1;
+
+		int64_t p = c[Degree - 1];
+		for (int i = Degree - 2; i >= 0; i--) {
+			p = c[i] + ((p * t) >> 30);
+		}
+		return (exponent << 16) + int32_t((p * t) >> 44);
+	}
+}
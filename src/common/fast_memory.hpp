@@ -0,0 +1,38 @@
+#pragma once
+
+/**
+ * Placement of hot code and lookup tables in SRAM.
+ *
+ * Flash runs with wait states at 84 MHz, which the ART accelerator only hides
+ * for straight-line code and sequential reads. Functions marked LPSR_FASTCODE
+ * and constants marked LPSR_FASTDATA go to the .fastcode and .fastdata
+ * sections, which scripts/linkerscript.ld places in SRAM and the startup code
+ * copies there from flash.
+ *
+ * GCC drops the section attribute of template instantiations, so the linker
+ * script also picks the hot template kernels by their input sections, the
+ * names -ffunction-sections and -fdata-sections give them, and the CMSIS-DSP
+ * FFT by its object files. A kernel added here must be added there too, the
+ * build's placement report lists hot functions left in flash.
+ *
+ * A marked function is never inlined, its code would land in the caller's
+ * section otherwise. So mark the outermost function of a hot loop, what it
+ * inlines comes along. Only mark inline functions, templates and static
+ * constexpr members, so a section never holds both inline and other
+ * definitions of one translation unit, which GCC rejects as a section type
+ * conflict.
+ *
+ * -DFAST_RAM=OFF leaves everything in flash, with the same code, to compare
+ * the cycle counts of the prof stream with the SRAM build. The host build
+ * ignores the markers.
+ */
+#if defined(__arm__) && defined(LPSR_FAST_RAM)
+#define LPSR_FASTCODE [[gnu::section(".fastcode"), gnu::noinline]]
+#define LPSR_FASTDATA [[gnu::section(".fastdata")]]
+#elif defined(__arm__)
+#define LPSR_FASTCODE [[gnu::noinline]]
+#define LPSR_FASTDATA
+#else
+#define LPSR_FASTCODE
+#define LPSR_FASTDATA
+#endif
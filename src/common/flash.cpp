@@ -0,0 +1,51 @@
+#include "flash.hpp"
+#include <modm/platform/device.hpp>
+
+namespace {
+
+	constexpr uint32_t errorFlags = FLASH_SR_PGSERR | FLASH_SR_PGPERR | FLASH_SR_PGAERR | FLASH_SR_WRPERR | FLASH_SR_SOP;
+
+	void unlock() {
+		if (FLASH->CR & FLASH_CR_LOCK) {
+			FLASH->KEYR = 0x4567'0123;
+			FLASH->KEYR = 0xcdef'89ab;
+		}
+	}
+
+	void lock() {
+		FLASH->CR |= FLASH_CR_LOCK;
+	}
+
+	// Waits for the current operation, returns false if it failed
+	bool wait() {
+		while (FLASH->SR & FLASH_SR_BSY);
+		bool ok = (FLASH->SR & errorFlags) == 0;
+		FLASH->SR = errorFlags | FLASH_SR_EOP;
+		return ok;
+	}
+}
+
+bool flash::eraseSector(int sector) {
+	if (sector < 0 || sector >= numSectors) return false;
+	unlock();
+	wait();
+	// 32 bit parallelism, needs a supply voltage of at least 2.7 V
+	FLASH->CR = FLASH_CR_PSIZE_1 | (sector << FLASH_CR_SNB_Pos) | FLASH_CR_SER;
+	FLASH->CR |= FLASH_CR_STRT;
+	bool ok = wait();
+	FLASH->CR = 0;
+	lock();
+	return ok;
+}
+
+bool flash::programWord(uint32_t address, uint32_t word) {
+	if (address % sizeof(word) != 0 || sectorOf(address) < 0) return false;
+	unlock();
+	wait();
+	FLASH->CR = FLASH_CR_PSIZE_1 | FLASH_CR_PG;
+	*reinterpret_cast<volatile uint32_t*>(address) = word;
+	bool ok = wait();
+	FLASH->CR = 0;
+	lock();
+	return ok && *reinterpret_cast<volatile uint32_t*>(address) == word;
+}
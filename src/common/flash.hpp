@@ -0,0 +1,66 @@
+#pragma once
+#include <cstdint>
+
+/**
+ * Minimal driver for the STM32F401's internal flash.
+ *
+ * Erasing and programming stall all reads from flash, including instruction
+ * fetches and interrupt handlers, for as long as the operation takes
+ * (about 1 s to erase a 128 kB sector, 16 us per word).
+ */
+namespace flash {
+
+	constexpr uint32_t baseAddress = 0x0800'0000;
+	constexpr int numSectors = 8;
+	// Offsets of the sectors from the flash base, the last entry is the end of flash
+	constexpr uint32_t sectorOffsets[numSectors + 1] = {
+		0x0'0000, 0x0'4000, 0x0'8000, 0x0'c000, 0x1'0000, 0x2'0000, 0x4'0000, 0x6'0000, 0x8'0000
+	};
+
+	// Number of the sector containing an address, -1 if it is not in flash
+	constexpr int sectorOf(uint32_t address) {
+		for (int i = 0; i < numSectors; i++) {
+			if (address >= baseAddress + sectorOffsets[i] && address < baseAddress + sectorOffsets[i + 1]) return i;
+		}
+		return -1;
+	}
+
+	bool eraseSector(int sector);
+
+	// Address must be word aligned, and the word erased before
+	bool programWord(uint32_t address, uint32_t word);
+
+	// A range of whole sectors that can be erased and rewritten at runtime
+	class Region {
+	public:
+		Region(const void* start, const void* end) :
+			start(reinterpret_cast<uint32_t>(start)), end(reinterpret_cast<uint32_t>(end)) {}
+
+		const uint8_t* data() const {
+			return reinterpret_cast<const uint8_t*>(start);
+		}
+
+		uint32_t size() const {
+			return end - start;
+		}
+
+		bool erase() {
+			int first = sectorOf(start);
+			int last = sectorOf(end - 1);
+			if (first < 0 || last < 0) return false;
+			for (int sector = first; sector <= last; sector++) {
+				if (!eraseSector(sector)) return false;
+			}
+			return true;
+		}
+
+		bool program(uint32_t offset, uint32_t word) {
+			if (offset + sizeof(word) > size()) return false;
+			return programWord(start + offset, word);
+		}
+
+	private:
+		uint32_t start;
+		uint32_t end;
+	};
+}
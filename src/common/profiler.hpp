@@ -0,0 +1,167 @@
+#pragma once
+#include <array>
+#include <cstdint>
+#include <cstring>
+
+#include <common/cycle_counter.hpp>
+
+/**
+ * Scoped-zone profiler.
+ *
+ * PROFILE_ZONE("name") measures the cycles from that point to the end of the
+ * enclosing scope and accumulates them into the zone with that name. Each zone
+ * keeps its count, min, max, mean and a histogram of log2(cycles).
+ *
+ * Unless LPSR_PROFILING is defined, PROFILE_ZONE expands to nothing and
+ * profiler::dump() prints nothing, so the instrumentation can stay in the code.
+ *
+ * Zones may be used from thread mode and interrupts alike, but each zone only
+ * from one of them.
+ */
+namespace profiler {
+
+constexpr int maxZones = 16;
+constexpr int numHistogramBuckets = 32;
+
+struct Zone {
+	const char* name = nullptr;
+	uint32_t count = 0;
+	uint32_t min = UINT32_MAX;
+	uint32_t max = 0;
+	uint32_t last = 0;
+	uint64_t total = 0;
+	// Bucket n counts durations in [2^n, 2^(n+1)), bucket 0 also counts 0
+	std::array<uint32_t, numHistogramBuckets> histogram = {};
+
+	void add(uint32_t cycles) {
+		count += 1;
+		min = (cycles < min) ? cycles : min;
+		max = (cycles > max) ? cycles : max;
+		last = cycles;
+		total += cycles;
+		int bucket = (cycles == 0) ? 0 : (31 - __builtin_clz(cycles));
+		histogram[bucket] += 1;
+	}
+
+	uint32_t mean() const {
+		return (count > 0) ? static_cast<uint32_t>(total / count) : 0;
+	}
+
+	void reset() {
+		const char* zoneName = name;
+		*this = Zone();
+		name = zoneName;
+	}
+};
+
+namespace detail {
+	inline std::array<Zone, maxZones> zones;
+	inline int numZones = 0;
+	inline Zone overflowZone = { "(overflow)" };
+
+	// Keeps interrupts from creating a zone while thread mode does
+	class CreationLock {
+	public:
+#if defined(__arm__)
+		CreationLock() : primask(__get_PRIMASK()) {
+			__disable_irq();
+		}
+		~CreationLock() {
+			__set_PRIMASK(primask);
+		}
+
+	private:
+		uint32_t primask;
+#else
+		CreationLock() {}
+#endif
+	};
+}
+
+// Returns the zone with the given name, creating it on first use.
+inline Zone& zone(const char* name) {
+	detail::CreationLock lock;
+	for (int i = 0; i < detail::numZones; i++) {
+		if (std::strcmp(detail::zones[i].name, name) == 0) {
+			return detail::zones[i];
+		}
+	}
+	if (detail::numZones == maxZones) {
+		return detail::overflowZone;
+	}
+	Zone& newZone = detail::zones[detail::numZones++];
+	newZone.name = name;
+	return newZone;
+}
+
+inline void reset() {
+	for (int i = 0; i < detail::numZones; i++) {
+		detail::zones[i].reset();
+	}
+}
+
+template<typename Function>
+void forEachZone(Function function) {
+	for (int i = 0; i < detail::numZones; i++) {
+		function(static_cast<const Zone&>(detail::zones[i]));
+	}
+}
+
+/**
+ * Prints one line per zone:
+ *
+ *     prof:<name> n:<count> min:<cycles> max:<cycles> mean:<cycles> hist:<bucket>=<count>,...
+ *
+ * Only non-empty histogram buckets are printed.
+ */
+template<typename Stream>
+void dump(Stream& out) {
+#ifdef LPSR_PROFILING
+	forEachZone([&](const Zone& zone) {
+		out << "prof:" << zone.name;
+		out << " n:" << zone.count;
+		out << " min:" << ((zone.count > 0) ? zone.min : 0);
+		out << " max:" << zone.max;
+		out << " mean:" << zone.mean();
+		out << " hist:";
+		const char* separator = "";
+		for (int i = 0; i < numHistogramBuckets; i++) {
+			if (zone.histogram[i] > 0) {
+				out << separator << i << "=" << zone.histogram[i];
+				separator = ",";
+			}
+		}
+		out << "\n";
+	});
+#else
+	(void) out;
+#endif
+}
+
+class ScopedTimer {
+public:
+	explicit ScopedTimer(Zone& zone) : zone(zone), start(cycleCounter::now()) {}
+	~ScopedTimer() {
+		zone.add(cycleCounter::now() - start);
+	}
+
+	ScopedTimer(const ScopedTimer&) = delete;
+	ScopedTimer& operator=(const ScopedTimer&) = delete;
+
+private:
+	Zone& zone;
+	uint32_t start;
+};
+
+}
+
+#define PROFILER_CONCAT_(a, b) a ## b
+#define PROFILER_CONCAT(a, b) PROFILER_CONCAT_(a, b)
+
+#ifdef LPSR_PROFILING
+#define PROFILE_ZONE(name) \
+	static profiler::Zone& PROFILER_CONCAT(profilerZone, __LINE__) = profiler::zone(name); \
+	profiler::ScopedTimer PROFILER_CONCAT(profilerTimer, __LINE__)(PROFILER_CONCAT(profilerZone, __LINE__))
+#else
+#define PROFILE_ZONE(name) do {} while (0)
+#endif
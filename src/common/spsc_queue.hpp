@@ -0,0 +1,70 @@
+#pragma once
+#include <array>
+#include <atomic>
+#include <cstdint>
+
+/**
+ * Fixed capacity FIFO for handing items from one producer to one consumer,
+ * e.g. from an interrupt to thread mode, without locks.
+ *
+ * The producer only writes tail and the consumer only writes head, both count
+ * items since construction and wrap modulo 2^32, so a full and an empty queue
+ * can be told apart without a spare slot. Capacity must be a power of two for
+ * the counters to stay consistent across the wrap.
+ *
+ * clear() is not safe while the other side is active.
+ */
+template<typename T, int Capacity>
+class SpscQueue {
+	static_assert(Capacity > 0 && (Capacity & (Capacity - 1)) == 0, "capacity must be a power of two");
+
+public:
+	// Producer side, returns false and drops the item if the queue is full
+	bool push(const T& item) {
+		const uint32_t currentTail = tail.load(std::memory_order_relaxed);
+		if (currentTail - head.load(std::memory_order_acquire) == Capacity) return false;
+		items[currentTail % Capacity] = item;
+		tail.store(currentTail + 1, std::memory_order_release);
+		return true;
+	}
+
+	// Consumer side, returns false if the queue is empty
+	bool pop(T& item) {
+		const uint32_t currentHead = head.load(std::memory_order_relaxed);
+		if (tail.load(std::memory_order_acquire) == currentHead) return false;
+		item = items[currentHead % Capacity];
+		head.store(currentHead + 1, std::memory_order_release);
+		return true;
+	}
+
+	bool empty() const {
+		return size() == 0;
+	}
+
+	bool full() const {
+		return size() == Capacity;
+	}
+
+	// Exact on either side, a snapshot from anywhere else
+	int size() const {
+		// Head first, it never passes a later tail
+		const uint32_t currentHead = head.load(std::memory_order_acquire);
+		return tail.load(std::memory_order_acquire) - currentHead;
+	}
+
+	// Empties the queue with both counters at count, the host test starts
+	// them just below the wrap
+	void clear(uint32_t count = 0) {
+		head.store(count, std::memory_order_relaxed);
+		tail.store(count, std::memory_order_relaxed);
+	}
+
+	static constexpr int capacity() {
+		return Capacity;
+	}
+
+private:
+	std::array<T, Capacity> items;
+	std::atomic<uint32_t> head = 0;
+	std::atomic<uint32_t> tail = 0;
+};
@@ -0,0 +1,19 @@
+#include <stdint.h>
+
+/*
+ * Portable version of the bit reversal in src/common/arm_bitreversal2.sx,
+ * which is Cortex-M assembly, for the CMSIS-DSP FFT in the host build.
+ */
+void arm_bitreversal_32(uint32_t* pSrc, const uint16_t bitRevLen, const uint16_t* pBitRevTab) {
+	for (uint32_t i = 0; i < bitRevLen; i += 2) {
+		// The table holds byte offsets of float pairs
+		uint32_t a = pBitRevTab[i] >> 2;
+		uint32_t b = pBitRevTab[i + 1] >> 2;
+		uint32_t tmp = pSrc[a];
+		pSrc[a] = pSrc[b];
+		pSrc[b] = tmp;
+		tmp = pSrc[a + 1];
+		pSrc[a + 1] = pSrc[b + 1];
+		pSrc[b + 1] = tmp;
+	}
+}
@@ -0,0 +1,150 @@
+#include "audio_file.hpp"
+
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+#include <cstring>
+#include <strings.h>
+
+namespace audio {
+
+namespace {
+
+constexpr uint16_t formatPcm = 1;
+constexpr uint16_t formatFloat = 3;
+constexpr uint16_t formatExtensible = 0xfffe;
+
+struct FormatChunk {
+	uint16_t format;
+	uint16_t channels;
+	uint32_t sampleRate;
+	uint32_t byteRate;
+	uint16_t blockAlign;
+	uint16_t bitsPerSample;
+};
+
+bool hasExtension(const char* path, const char* extension) {
+	size_t pathLength = std::strlen(path);
+	size_t extensionLength = std::strlen(extension);
+	return pathLength >= extensionLength && strcasecmp(path + pathLength - extensionLength, extension) == 0;
+}
+
+uint32_t readLittleEndian(const uint8_t* bytes, int size) {
+	uint32_t value = 0;
+	for (int i = 0; i < size; i++) {
+		value |= uint32_t(bytes[i]) << (8 * i);
+	}
+	return value;
+}
+
+// One sample scaled to [-1, 1)
+float decodeSample(const uint8_t* bytes, uint16_t format, int bitsPerSample) {
+	if (format == formatFloat) {
+		float value;
+		std::memcpy(&value, bytes, sizeof(value));
+		return value;
+	}
+	if (bitsPerSample == 8) {
+		// 8 bit WAV is unsigned
+		return (int(bytes[0]) - 128) / 128.0f;
+	}
+	const int size = bitsPerSample / 8;
+	// Sign extend from the top byte
+	int32_t value = static_cast<int32_t>(readLittleEndian(bytes, size) << (32 - 8 * size));
+	return value / 2147483648.0f;
+}
+
+int16_t toPcm16(float sample) {
+	return static_cast<int16_t>(std::clamp(std::lround(sample * 32768.0f), -32768l, 32767l));
+}
+
+}
+
+bool readWav(const char* path, Clip& clip) {
+	FILE* file = std::fopen(path, "rb");
+	if (file == nullptr) return false;
+	std::vector<uint8_t> bytes;
+	uint8_t buffer[4096];
+	size_t count;
+	while ((count = std::fread(buffer, 1, sizeof(buffer), file)) > 0) {
+		bytes.insert(bytes.end(), buffer, buffer + count);
+	}
+	std::fclose(file);
+
+	if (bytes.size() < 12 || std::memcmp(bytes.data(), "RIFF", 4) != 0 || std::memcmp(bytes.data() + 8, "WAVE", 4) != 0) return false;
+
+	FormatChunk fmt = {};
+	bool haveFormat = false;
+	const uint8_t* data = nullptr;
+	size_t dataSize = 0;
+	size_t offset = 12;
+	while (offset + 8 <= bytes.size()) {
+		const uint8_t* chunk = bytes.data() + offset;
+		const size_t chunkSize = std::min<size_t>(readLittleEndian(chunk + 4, 4), bytes.size() - offset - 8);
+		if (std::memcmp(chunk, "fmt ", 4) == 0 && chunkSize >= 16) {
+			fmt.format = readLittleEndian(chunk + 8, 2);
+			fmt.channels = readLittleEndian(chunk + 10, 2);
+			fmt.sampleRate = readLittleEndian(chunk + 12, 4);
+			fmt.byteRate = readLittleEndian(chunk + 16, 4);
+			fmt.blockAlign = readLittleEndian(chunk + 20, 2);
+			fmt.bitsPerSample = readLittleEndian(chunk + 22, 2);
+			if (fmt.format == formatExtensible && chunkSize >= 26) {
+				// The format is the start of the sub format GUID
+				fmt.format = readLittleEndian(chunk + 32, 2);
+			}
+			haveFormat = true;
+		}
+		else if (std::memcmp(chunk, "data", 4) == 0) {
+			data = chunk + 8;
+			dataSize = chunkSize;
+		}
+		// Chunks are padded to an even size
+		offset += 8 + chunkSize + (chunkSize & 1);
+	}
+	if (!haveFormat || data == nullptr || fmt.channels == 0 || fmt.sampleRate == 0) return false;
+
+	const bool validPcm = fmt.format == formatPcm && fmt.bitsPerSample % 8 == 0 && fmt.bitsPerSample >= 8 && fmt.bitsPerSample <= 32;
+	const bool validFloat = fmt.format == formatFloat && fmt.bitsPerSample == 32;
+	if (!validPcm && !validFloat) return false;
+	const size_t sampleSize = fmt.bitsPerSample / 8;
+	if (fmt.blockAlign < sampleSize * fmt.channels) return false;
+
+	const size_t numFrames = dataSize / fmt.blockAlign;
+	clip.sampleRate = fmt.sampleRate;
+	clip.samples.resize(numFrames);
+	for (size_t i = 0; i < numFrames; i++) {
+		const uint8_t* frame = data + i * fmt.blockAlign;
+		float sum = 0;
+		for (int channel = 0; channel < fmt.channels; channel++) {
+			sum += decodeSample(frame + channel * sampleSize, fmt.format, fmt.bitsPerSample);
+		}
+		clip.samples[i] = toPcm16(sum / fmt.channels);
+	}
+	return true;
+}
+
+bool readPcm(const char* path, uint32_t sampleRate, Clip& clip) {
+	FILE* file = std::fopen(path, "rb");
+	if (file == nullptr) return false;
+	clip.sampleRate = sampleRate;
+	clip.samples.clear();
+	uint8_t buffer[4096];
+	size_t count;
+	while ((count = std::fread(buffer, 2, sizeof(buffer) / 2, file)) > 0) {
+		for (size_t i = 0; i < count; i++) {
+			clip.samples.push_back(static_cast<int16_t>(readLittleEndian(buffer + 2 * i, 2)));
+		}
+	}
+	std::fclose(file);
+	return true;
+}
+
+bool isWav(const char* path) {
+	return hasExtension(path, ".wav");
+}
+
+bool isPcm(const char* path) {
+	return hasExtension(path, ".pcm");
+}
+
+}
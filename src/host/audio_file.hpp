@@ -0,0 +1,30 @@
+#pragma once
+#include <cstdint>
+#include <vector>
+
+/**
+ * Loads audio clips for the front end: WAV files (integer PCM of 8 to 32 bit
+ * or 32 bit float, any number of channels) and raw 16 bit signed little
+ * endian PCM. Channels are mixed to mono, the sample rate is kept, see
+ * PolyphaseResampler to convert it.
+ */
+namespace audio {
+
+	struct Clip {
+		uint32_t sampleRate = 0;
+		std::vector<int16_t> samples;
+	};
+
+	bool readWav(const char* path, Clip& clip);
+
+	// Raw PCM has no header, the sample rate must be given
+	bool readPcm(const char* path, uint32_t sampleRate, Clip& clip);
+
+	bool isWav(const char* path);
+	bool isPcm(const char* path);
+
+	// 16 bit PCM to the counts of the 12 bit ADC centered on the supply midpoint
+	inline uint16_t pcmToAdc(int16_t sample) {
+		return static_cast<uint16_t>((sample + 32768) >> 4);
+	}
+}
@@ -0,0 +1,79 @@
+#include "engine.hpp"
+
+#include <algorithm>
+
+#include "audio_file.hpp"
+
+struct Engine::Stream {
+	int id;
+	Recognizer<EngineVocabulary> recognizer;
+	// Samples not yet processed start at inputStart
+	std::vector<int16_t> input;
+	size_t inputStart = 0;
+	latency::SampleIndex sampleIndex = 0;
+	std::vector<Event> events;
+
+	Stream(int id, const EngineVocabulary& vocabulary) : id(id), recognizer(vocabulary) {}
+};
+
+Engine::Engine(const templatedb::Database& templates, int threads) : pool(threads) {
+	if (templates.isOpen()) {
+		// Otherwise the vocabulary would silently drop templates, or the DTW overrun its rows
+		templatesError = templates.check(featureVectorDim, maxTemplates, maxTemplateFrames);
+		if (templatesError != templatedb::Error::None) return;
+	}
+	for (int i = 0; i < templates.size(); i++) {
+		vocabulary.add(templates.text(i), templates.frames<featureVectorDim>(i), templates.numFrames(i));
+	}
+}
+
+Engine::~Engine() = default;
+
+int Engine::addStream() {
+	const int id = streams.size();
+	streams.push_back(std::make_unique<Stream>(id, vocabulary));
+	return id;
+}
+
+void Engine::push(int stream, const int16_t* samples, size_t count) {
+	std::vector<int16_t>& input = streams[stream]->input;
+	input.insert(input.end(), samples, samples + count);
+}
+
+void Engine::process() {
+	// Job j runs the streams j, j + numJobs, ...
+	const int numJobs = std::min<int>(streams.size(), pool.size() * jobsPerWorker);
+	for (int job = 0; job < numJobs; job++) {
+		pool.submit(job % pool.size(), [this, job, numJobs] {
+			for (size_t stream = job; stream < streams.size(); stream += numJobs) {
+				processStream(*streams[stream]);
+			}
+		});
+	}
+	pool.wait();
+}
+
+void Engine::processStream(Stream& stream) {
+	while (stream.input.size() - stream.inputStart >= size_t(windowStride)) {
+		const latency::SampleIndex blockStart = stream.sampleIndex;
+		stream.sampleIndex += windowStride;
+		auto segment = stream.recognizer.addBlock(stream.input.data() + stream.inputStart, audio::pcmToAdc, blockStart);
+		stream.inputStart += windowStride;
+		stream.recognizer.computeFeatures(false);
+		if (segment.wordFinished) {
+			auto result = stream.recognizer.recognize();
+			const char* text = (result.commandIdx >= 0) ? vocabulary[result.commandIdx].text : nullptr;
+			stream.events.push_back(Event{ stream.id, text, result, stream.sampleIndex });
+		}
+	}
+	// Keep the remainder of a block at the start of the buffer, which keeps its capacity
+	stream.input.erase(stream.input.begin(), stream.input.begin() + stream.inputStart);
+	stream.inputStart = 0;
+}
+
+void Engine::takeEvents(std::vector<Event>& events) {
+	for (const std::unique_ptr<Stream>& stream : streams) {
+		events.insert(events.end(), stream->events.begin(), stream->events.end());
+		stream->events.clear();
+	}
+}
@@ -0,0 +1,86 @@
+#pragma once
+#include <cstdint>
+#include <memory>
+#include <vector>
+
+#include <app/parameters.hpp>
+#include <app/recognizer.hpp>
+#include <app/template_db.hpp>
+
+#include "thread_pool.hpp"
+
+/**
+ * Runs many recognizer streams on a fixed number of threads, e.g. on a
+ * gateway serving many devices.
+ *
+ * The streams share the template database and the vocabulary, each keeps
+ * only its own pipeline state. process() splits the streams into
+ * jobsPerWorker jobs per thread. A job runs all queued blocks of one stream
+ * before moving to the next, so a stream's state stays in the cache while it
+ * is processed. Every job goes to the same worker from call to call, so with
+ * an even load a stream stays on one core. A worker that runs out of jobs
+ * steals those queued at the others, so streams with more audio or a word to
+ * recognize do not leave the other workers idle.
+ *
+ * push(), takeEvents() and addStream() must not be called while process() runs.
+ */
+class Engine {
+public:
+	using EngineVocabulary = Vocabulary<FeatureVector, maxTemplates>;
+
+	struct Event {
+		int stream;
+		// Vocabulary entry text, nullptr if there are no templates
+		const char* text;
+		Recognizer<EngineVocabulary>::Result result;
+		// Samples of the stream processed when the word was recognized
+		latency::SampleIndex decision;
+	};
+
+	// The templates must stay valid while the engine exists, 0 threads uses one
+	// per hardware thread. An open database that does not pass check() for the
+	// recognizer's limits is not used at all, templateError() tells why; a
+	// closed one runs the streams without templates.
+	Engine(const templatedb::Database& templates, int threads = 0);
+	Engine(const Engine&) = delete;
+	Engine& operator=(const Engine&) = delete;
+	~Engine();
+
+	int addStream();
+
+	// Queues 16 bit PCM samples at sampleRate for a stream
+	void push(int stream, const int16_t* samples, size_t count);
+
+	// Processes all complete blocks of all streams, returns when done
+	void process();
+
+	// Appends the words recognized since the last call
+	void takeEvents(std::vector<Event>& events);
+
+	int numStreams() const {
+		return streams.size();
+	}
+
+	int numThreads() const {
+		return pool.size();
+	}
+
+	// Why the templates given to the constructor are not used, None if they are
+	templatedb::Error templateError() const {
+		return templatesError;
+	}
+
+private:
+	struct Stream;
+
+	EngineVocabulary vocabulary;
+	templatedb::Error templatesError = templatedb::Error::None;
+	// More than one, so there is work left to steal. More jobs even out the
+	// load better, but each costs a hand-off to the pool.
+	static constexpr int jobsPerWorker = 4;
+
+	std::vector<std::unique_ptr<Stream>> streams;
+	ThreadPool pool;
+
+	void processStream(Stream& stream);
+};
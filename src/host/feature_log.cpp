@@ -0,0 +1,43 @@
+#include "feature_log.hpp"
+
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+
+namespace featurelog {
+
+bool parseLine(const char* line, Frame& frame) {
+	constexpr const char prefix[] = "mfcc:";
+	if (std::strncmp(line, prefix, sizeof(prefix) - 1) != 0) return false;
+
+	const char* cursor = line + sizeof(prefix) - 1;
+	char* end;
+	frame.rmsAmplitude = std::strtof(cursor, &end);
+	if (end == cursor) return false;
+	cursor = end;
+
+	frame.cepstrum[0] = 0;
+	for (int i = 1; i < numCoefficients; i++) {
+		frame.cepstrum[i] = std::strtof(cursor, &end);
+		if (end == cursor) return false;
+		cursor = end;
+	}
+	return true;
+}
+
+bool readFile(const char* path, std::vector<Frame>& frames) {
+	FILE* file = std::fopen(path, "r");
+	if (file == nullptr) return false;
+
+	char line[1024];
+	Frame frame;
+	while (std::fgets(line, sizeof(line), file) != nullptr) {
+		if (parseLine(line, frame)) {
+			frames.push_back(frame);
+		}
+	}
+	std::fclose(file);
+	return true;
+}
+
+}
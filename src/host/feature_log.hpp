@@ -0,0 +1,29 @@
+#pragma once
+#include <array>
+#include <vector>
+
+/**
+ * Reader for the feature logs in the data directory, as printed by the firmware's
+ * mfcc telemetry stream and recorded with scripts/mfcc_record.py:
+ *
+ *     mfcc:<rms amplitude> <cepstrum 1> ... <cepstrum 15>
+ *
+ * Lines with any other prefix are skipped.
+ */
+namespace featurelog {
+
+	constexpr int numCoefficients = 16;
+
+	struct Frame {
+		float rmsAmplitude = 0;
+		// cepstrum[k] is the k-th DCT coefficient of the log mel spectrum,
+		// the 0th coefficient is not logged and left at 0
+		std::array<float, numCoefficients> cepstrum = {};
+	};
+
+	// Parses one line, returns false if it is not a complete mfcc: line
+	bool parseLine(const char* line, Frame& frame);
+
+	// Appends all frames in a log file, returns false if it could not be read
+	bool readFile(const char* path, std::vector<Frame>& frames);
+}
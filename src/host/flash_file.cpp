@@ -0,0 +1,67 @@
+#include "flash_file.hpp"
+
+#include <algorithm>
+#include <cstring>
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+bool FlashFile::Region::erase() {
+	std::memset(file.bytes + offset, 0xff, regionSize);
+	file.erases += 1;
+	return true;
+}
+
+bool FlashFile::Region::program(uint32_t wordOffset, uint32_t word) {
+	if (wordOffset % sizeof(word) != 0 || wordOffset + sizeof(word) > regionSize) return false;
+	uint8_t* address = file.bytes + offset + wordOffset;
+	uint32_t current;
+	std::memcpy(&current, address, sizeof(current));
+	if (current != 0xffffffff) return false;
+	std::memcpy(address, &word, sizeof(word));
+	return true;
+}
+
+FlashFile::~FlashFile() {
+	close();
+}
+
+bool FlashFile::open(const char* path, uint32_t size) {
+	close();
+	int fd = ::open(path, O_RDWR | O_CREAT, 0644);
+	if (fd < 0) return false;
+
+	struct stat status;
+	if (::fstat(fd, &status) != 0) {
+		::close(fd);
+		return false;
+	}
+	// Extend the file with erased bytes
+	uint8_t erased[256];
+	std::memset(erased, 0xff, sizeof(erased));
+	for (off_t position = status.st_size; position < off_t(size); position += sizeof(erased)) {
+		size_t length = std::min<size_t>(sizeof(erased), size - position);
+		if (::pwrite(fd, erased, length, position) != ssize_t(length)) {
+			::close(fd);
+			return false;
+		}
+	}
+
+	void* address = ::mmap(nullptr, size, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+	::close(fd);
+	if (address == MAP_FAILED) return false;
+	bytes = static_cast<uint8_t*>(address);
+	fileSize = size;
+	erases = 0;
+	return true;
+}
+
+void FlashFile::close() {
+	if (bytes != nullptr) {
+		::munmap(bytes, fileSize);
+		bytes = nullptr;
+		fileSize = 0;
+	}
+}
@@ -0,0 +1,59 @@
+#pragma once
+#include <cstddef>
+#include <cstdint>
+
+/**
+ * Flash emulated in a memory-mapped file, for running the flash storage code
+ * (template upload, enrollment log) on the host.
+ *
+ * Like the target's flash, erasing sets all bytes to 0xff and a word can only
+ * be programmed once after it was erased, otherwise program() fails. The file
+ * is created erased if it does not exist.
+ */
+class FlashFile {
+public:
+	// A part of the file with the same interface as flash::Region
+	class Region {
+	public:
+		Region(FlashFile& file, uint32_t offset, uint32_t size) : file(file), offset(offset), regionSize(size) {}
+
+		const uint8_t* data() const {
+			return file.bytes + offset;
+		}
+
+		uint32_t size() const {
+			return regionSize;
+		}
+
+		bool erase();
+		bool program(uint32_t offset, uint32_t word);
+
+	private:
+		FlashFile& file;
+		uint32_t offset;
+		uint32_t regionSize;
+	};
+
+	FlashFile() = default;
+	FlashFile(const FlashFile&) = delete;
+	FlashFile& operator=(const FlashFile&) = delete;
+	~FlashFile();
+
+	// Maps the file, creating or extending it to size bytes
+	bool open(const char* path, uint32_t size);
+	void close();
+
+	uint32_t size() const {
+		return fileSize;
+	}
+
+	// Number of erase operations since open(), to check wear levelling
+	uint32_t eraseCount() const {
+		return erases;
+	}
+
+private:
+	uint8_t* bytes = nullptr;
+	uint32_t fileSize = 0;
+	uint32_t erases = 0;
+};
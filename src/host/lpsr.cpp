@@ -0,0 +1,165 @@
+#include "lpsr.h"
+
+#include <algorithm>
+#include <array>
+#include <cstring>
+#include <new>
+
+#include <app/parameters.hpp>
+#include <app/recognizer.hpp>
+#include <app/template_db.hpp>
+#include <common/spsc_queue.hpp>
+
+#include "audio_file.hpp"
+
+static_assert(LPSR_SAMPLE_RATE == sampleRate && LPSR_BLOCK_SIZE == windowStride);
+static_assert(LPSR_NUM_COEFFICIENTS == numMelCoefficients && LPSR_MAX_TEXT == templatedb::maxTextLength + 1);
+
+namespace {
+
+constexpr int frameQueueSize = 64;
+constexpr int eventQueueSize = 8;
+
+}
+
+using StreamVocabulary = Vocabulary<FeatureVector, maxTemplates>;
+
+// One stream, the recognizer with its templates and output queues
+struct lpsr_state {
+	unsigned flags = 0;
+	templatedb::Database templates;
+	StreamVocabulary vocabulary;
+	Recognizer<StreamVocabulary> recognizer{ vocabulary };
+
+	// Samples of an incomplete block
+	std::array<int16_t, windowStride> pending;
+	int numPending = 0;
+	uint32_t sampleIndex = 0;
+
+	SpscQueue<lpsr_frame, frameQueueSize> frames;
+	SpscQueue<lpsr_event, eventQueueSize> events;
+
+	void reset() {
+		recognizer.reset();
+		numPending = 0;
+		sampleIndex = 0;
+		frames.clear();
+		events.clear();
+	}
+
+	// Runs one block through the pipeline, false if its output would not fit the queues
+	bool processBlock(const int16_t* block) {
+		const bool emitFrame = flags & LPSR_FRAMES;
+		if ((emitFrame && frames.full()) || events.full()) return false;
+
+		const uint32_t blockStart = sampleIndex;
+		sampleIndex += windowStride;
+		auto segment = recognizer.addBlock(block, audio::pcmToAdc, blockStart);
+		recognizer.computeFeatures(emitFrame);
+		if (emitFrame) {
+			const FrontEnd& frontEnd = recognizer.frontEnd();
+			lpsr_frame frame;
+			frame.sample_index = blockStart;
+			frame.rms_amplitude = frontEnd.amplitude();
+			std::copy(frontEnd.cepstrum().begin(), frontEnd.cepstrum().end(), frame.cepstrum);
+			frame.cepstrum[0] = 0;
+			frames.push(frame);
+		}
+
+		if (segment.wordFinished) {
+			auto result = recognizer.recognize();
+			lpsr_event event;
+			std::memset(&event, 0, sizeof(event));
+			event.template_index = result.commandIdx;
+			if (result.commandIdx >= 0) {
+				std::strcpy(event.text, vocabulary[result.commandIdx].text);
+			}
+			event.cost = result.cost;
+			event.num_frames = result.wordLength;
+			event.speech_start = result.speechStart;
+			event.speech_end = result.speechEnd;
+			event.decision = sampleIndex;
+			events.push(event);
+		}
+		return true;
+	}
+
+	size_t push(const int16_t* samples, size_t count) {
+		size_t consumed = 0;
+		if (numPending > 0) {
+			// Complete the block started by the last push
+			const size_t n = std::min(count, size_t(windowStride - numPending));
+			std::copy(samples, samples + n, pending.begin() + numPending);
+			numPending += n;
+			consumed += n;
+			if (numPending < windowStride || !processBlock(pending.data())) return consumed;
+			numPending = 0;
+		}
+		// Whole blocks are read in place
+		while (count - consumed >= size_t(windowStride)) {
+			if (!processBlock(samples + consumed)) return consumed;
+			consumed += windowStride;
+		}
+		std::copy(samples + consumed, samples + count, pending.begin());
+		numPending = count - consumed;
+		return count;
+	}
+};
+
+size_t lpsr_state_size(void) {
+	return sizeof(lpsr_state);
+}
+
+size_t lpsr_state_alignment(void) {
+	return alignof(lpsr_state);
+}
+
+lpsr_status lpsr_init(void* memory, size_t size, const void* templates, size_t templates_size, unsigned flags, lpsr_state** state) {
+	if (memory == nullptr || state == nullptr || size < sizeof(lpsr_state)
+			|| reinterpret_cast<uintptr_t>(memory) % alignof(lpsr_state) != 0) {
+		return LPSR_BAD_ARGUMENT;
+	}
+	lpsr_state* stream = new (memory) lpsr_state;
+	stream->flags = flags;
+	if (templates != nullptr) {
+		templatedb::Error error = stream->templates.open(templates, templates_size);
+		if (error == templatedb::Error::None) {
+			error = stream->templates.check(featureVectorDim, maxTemplates, maxTemplateFrames);
+		}
+		if (error != templatedb::Error::None) return LPSR_BAD_TEMPLATES;
+		for (int i = 0; i < stream->templates.size(); i++) {
+			stream->vocabulary.add(stream->templates.text(i), stream->templates.frames<featureVectorDim>(i), stream->templates.numFrames(i));
+		}
+	}
+	*state = stream;
+	return LPSR_OK;
+}
+
+void lpsr_reset(lpsr_state* state) {
+	state->reset();
+}
+
+size_t lpsr_push(lpsr_state* state, const int16_t* samples, size_t count) {
+	return state->push(samples, count);
+}
+
+size_t lpsr_pull_frames(lpsr_state* state, lpsr_frame* frames, size_t max_frames) {
+	size_t n = 0;
+	while (n < max_frames && state->frames.pop(frames[n])) {
+		n += 1;
+	}
+	return n;
+}
+
+int lpsr_pull_event(lpsr_state* state, lpsr_event* event) {
+	return state->events.pop(*event) ? 1 : 0;
+}
+
+const char* lpsr_status_name(lpsr_status status) {
+	switch (status) {
+		case LPSR_OK: return "ok";
+		case LPSR_BAD_ARGUMENT: return "bad argument";
+		case LPSR_BAD_TEMPLATES: return "bad templates";
+	}
+	return "unknown";
+}
@@ -0,0 +1,103 @@
+#ifndef LPSR_H
+#define LPSR_H
+
+/*
+ * Streaming recognizer with a C ABI, for running the firmware's pipeline on a
+ * host, e.g. a gateway receiving audio from many devices.
+ *
+ * The caller owns all memory: it allocates lpsr_state_size() bytes aligned to
+ * lpsr_state_alignment() per stream and the template database, which must
+ * stay valid while the stream uses it. The library does not allocate, lock
+ * or keep global state, so every stream can run on its own thread. The output
+ * queues are lock-free, one thread may pull while another one pushes.
+ *
+ * Audio is 16 bit signed mono PCM at LPSR_SAMPLE_RATE. lpsr_push() reads the
+ * samples from the caller's buffer without staging them, except for the
+ * remainder of a block, and queues a feature frame for every LPSR_BLOCK_SIZE
+ * samples and an event for every word. The caller pulls them with
+ * lpsr_pull_frames() and lpsr_pull_event(); if a queue is full, lpsr_push()
+ * stops early and returns how many samples it consumed.
+ */
+
+#include <stddef.h>
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#if defined(__GNUC__)
+#define LPSR_API __attribute__((visibility("default")))
+#else
+#define LPSR_API
+#endif
+
+#define LPSR_SAMPLE_RATE 9650
+#define LPSR_BLOCK_SIZE 256
+#define LPSR_NUM_COEFFICIENTS 16
+#define LPSR_MAX_TEXT 16
+
+typedef struct lpsr_state lpsr_state;
+
+typedef enum lpsr_status {
+	LPSR_OK = 0,
+	LPSR_BAD_ARGUMENT,
+	/* The template database is invalid or does not fit the recognizer */
+	LPSR_BAD_TEMPLATES,
+} lpsr_status;
+
+typedef enum lpsr_flags {
+	/* Queue a feature frame for every block, otherwise only events are queued */
+	LPSR_FRAMES = 1,
+} lpsr_flags;
+
+typedef struct lpsr_frame {
+	/* Index of the first sample of the block since lpsr_init() */
+	uint32_t sample_index;
+	float rms_amplitude;
+	/* Mel cepstrum, like the firmware's mfcc stream the 0th coefficient is 0 */
+	float cepstrum[LPSR_NUM_COEFFICIENTS];
+} lpsr_frame;
+
+typedef struct lpsr_event {
+	/* Best matching template, -1 if there are no templates */
+	int32_t template_index;
+	char text[LPSR_MAX_TEXT];
+	/* DTW cost of the best match */
+	uint32_t cost;
+	uint32_t num_frames;
+	/* Start of the first frame and end of the last loud frame of the word, in samples */
+	uint32_t speech_start;
+	uint32_t speech_end;
+	/* Samples pushed when the word was recognized */
+	uint32_t decision;
+} lpsr_event;
+
+LPSR_API size_t lpsr_state_size(void);
+LPSR_API size_t lpsr_state_alignment(void);
+
+/*
+ * Starts a stream in the given memory. The templates are a database as
+ * written by template_builder, NULL for none.
+ */
+LPSR_API lpsr_status lpsr_init(void* memory, size_t size, const void* templates, size_t templates_size, unsigned flags, lpsr_state** state);
+
+/* Forgets the audio and queued output, keeps the templates */
+LPSR_API void lpsr_reset(lpsr_state* state);
+
+/* Returns the number of samples consumed, less than count if a queue is full */
+LPSR_API size_t lpsr_push(lpsr_state* state, const int16_t* samples, size_t count);
+
+/* Copies up to max_frames queued frames, returns how many */
+LPSR_API size_t lpsr_pull_frames(lpsr_state* state, lpsr_frame* frames, size_t max_frames);
+
+/* Copies the oldest queued event, returns 0 if there is none */
+LPSR_API int lpsr_pull_event(lpsr_state* state, lpsr_event* event);
+
+LPSR_API const char* lpsr_status_name(lpsr_status status);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
@@ -0,0 +1,75 @@
+#include "resampler.hpp"
+
+#include <algorithm>
+#include <cmath>
+#include <numeric>
+
+namespace {
+
+constexpr double pi = 3.14159265358979323846;
+// Kaiser window shape, about 80 dB stop band attenuation
+constexpr double kaiserBeta = 8.0;
+
+// Modified Bessel function of the first kind, order 0
+double besselI0(double x) {
+	double sum = 1;
+	double term = 1;
+	for (int k = 1; k < 50; k++) {
+		term *= (x / (2 * k)) * (x / (2 * k));
+		sum += term;
+		if (term < sum * 1e-12) break;
+	}
+	return sum;
+}
+
+}
+
+PolyphaseResampler::PolyphaseResampler(uint32_t inputRate, uint32_t outputRate, int zeroCrossings) {
+	const uint32_t divisor = std::gcd(inputRate, outputRate);
+	up = outputRate / divisor;
+	down = inputRate / divisor;
+	tapsPerPhase = (2 * zeroCrossings * std::max(up, down) + up - 1) / up;
+
+	// Prototype low-pass at the upsampled rate, cut off below the lower Nyquist frequency
+	const int length = up * tapsPerPhase;
+	const double cutoff = passband * 0.5 / std::max(up, down);
+	// An integer center keeps the output aligned to the input samples
+	const int center = length / 2;
+	std::vector<double> prototype(length);
+	for (int i = 0; i < length; i++) {
+		const double t = i - center;
+		const double sinc = (t == 0) ? 2 * cutoff : std::sin(2 * pi * cutoff * t) / (pi * t);
+		const double ratio = t / center;
+		const double window = besselI0(kaiserBeta * std::sqrt(1 - ratio * ratio)) / besselI0(kaiserBeta);
+		// Upsampling by zero stuffing loses a factor of up in gain
+		prototype[i] = sinc * window * up;
+	}
+	delay = center;
+
+	// Phase p holds taps p, p + up, p + 2 up, ...
+	phases.resize(length);
+	for (int p = 0; p < up; p++) {
+		for (int k = 0; k < tapsPerPhase; k++) {
+			phases[p * tapsPerPhase + k] = prototype[p + k * up];
+		}
+	}
+}
+
+void PolyphaseResampler::process(const std::vector<int16_t>& input, std::vector<int16_t>& output) const {
+	const int64_t numInput = input.size();
+	const int64_t numOutput = (numInput * up + down - 1) / down;
+	output.resize(numOutput);
+	for (int64_t n = 0; n < numOutput; n++) {
+		// Position on the upsampled time axis, the newest input sample and the phase it falls on
+		const int64_t t = n * down + delay;
+		const int64_t newest = t / up;
+		const float* coefficients = phases.data() + (t % up) * tapsPerPhase;
+		float sum = 0;
+		const int first = std::max<int64_t>(0, newest - numInput + 1);
+		const int last = std::min<int64_t>(tapsPerPhase, newest + 1);
+		for (int k = first; k < last; k++) {
+			sum += coefficients[k] * input[newest - k];
+		}
+		output[n] = static_cast<int16_t>(std::clamp(std::lround(sum), -32768l, 32767l));
+	}
+}
@@ -0,0 +1,47 @@
+#pragma once
+#include <cstdint>
+#include <vector>
+
+/**
+ * Converts the sample rate of a clip by a rational factor with a polyphase
+ * windowed-sinc filter.
+ *
+ * The rates are reduced to up / down. Conceptually the input is upsampled by
+ * up, low-pass filtered below the lower of the two Nyquist frequencies and
+ * decimated by down; the polyphase form only evaluates the filter phase each
+ * output sample needs. The filter spans zeroCrossings periods of the cut-off
+ * on each side, so downsampling by a large factor needs more taps per output
+ * sample. The output is aligned with the input, the filter delay is
+ * compensated.
+ */
+class PolyphaseResampler {
+public:
+	static constexpr int defaultZeroCrossings = 16;
+	// Cut-off relative to the lower Nyquist frequency, leaves room for the transition band
+	static constexpr double passband = 0.9;
+
+	PolyphaseResampler(uint32_t inputRate, uint32_t outputRate, int zeroCrossings = defaultZeroCrossings);
+
+	void process(const std::vector<int16_t>& input, std::vector<int16_t>& output) const;
+
+	int upFactor() const {
+		return up;
+	}
+
+	int downFactor() const {
+		return down;
+	}
+
+	int taps() const {
+		return tapsPerPhase;
+	}
+
+private:
+	int up;
+	int down;
+	int tapsPerPhase;
+	// Filter delay on the upsampled time axis
+	int64_t delay;
+	// tapsPerPhase coefficients for each of the up phases
+	std::vector<float> phases;
+};
@@ -0,0 +1,63 @@
+#include "segmentation.hpp"
+
+#include <array>
+#include <cstdio>
+#include <cstring>
+
+#include <app/parameters.hpp>
+#include <app/word_segmenter.hpp>
+
+#include "session_file.hpp"
+#include "session_reader.hpp"
+
+namespace segmentation {
+
+	bool segmentSession(const char* path, std::vector<Word>& words) {
+		if (sessionfile::isSessionFile(path)) {
+			sessionfile::MappedSession session;
+			if (!session.open(path)) return false;
+			if (session.wordsCurrent(maxWords)) {
+				// Only the frames of the words are read
+				for (int w = 0; w < session.numWords(); w++) {
+					const sessionfile::WordInfo& info = session.word(w);
+					Word& word = words.emplace_back(info.numFrames);
+					for (uint32_t i = 0; i < info.numFrames; i++) {
+						computeFeatureVector(session.frame(info.firstFrame + i).cepstrum, word[i]);
+					}
+				}
+				return true;
+			}
+		}
+
+		SessionReader reader;
+		if (!reader.open(path)) return false;
+
+		WordSegmenter<maxWords> wordSegmenter;
+		std::array<FeatureVector, maxWords> wordBuffer;
+		featurelog::Frame frame;
+		while (reader.next(frame)) {
+			auto segment = wordSegmenter.update(frame.rmsAmplitude);
+			if (segment.storeFeatureVector) {
+				computeFeatureVector(frame.cepstrum, wordBuffer[segment.wordLength - 1]);
+			}
+			if (segment.wordFinished) {
+				words.emplace_back(wordBuffer.begin(), wordBuffer.begin() + segment.wordLength);
+			}
+		}
+		return true;
+	}
+
+	bool readWordList(const char* path, std::vector<std::string>& words) {
+		FILE* file = std::fopen(path, "r");
+		if (file == nullptr) return false;
+		char line[64];
+		while (std::fgets(line, sizeof(line), file) != nullptr) {
+			line[std::strcspn(line, "\r\n")] = '\0';
+			if (line[0] != '\0') {
+				words.push_back(line);
+			}
+		}
+		std::fclose(file);
+		return true;
+	}
+}
@@ -0,0 +1,19 @@
+#pragma once
+#include <string>
+#include <vector>
+
+#include <app/feature_vector.hpp>
+
+/**
+ * Word segmentation of recorded sessions, exactly like the firmware's main loop.
+ */
+namespace segmentation {
+
+	using Word = std::vector<FeatureVector>;
+
+	// Feature vectors of every word spoken in a session, false if it could not be read
+	bool segmentSession(const char* path, std::vector<Word>& words);
+
+	// One word per line, the n-th word spoken in a session is the n-th line
+	bool readWordList(const char* path, std::vector<std::string>& words);
+}
@@ -0,0 +1,146 @@
+#include "session_file.hpp"
+
+#include <cstdio>
+#include <cstring>
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include <app/parameters.hpp>
+#include <app/word_segmenter.hpp>
+
+namespace sessionfile {
+
+namespace {
+
+using Segmenter = WordSegmenter<maxWords>;
+
+std::vector<WordInfo> findWords(const std::vector<featurelog::Frame>& frames) {
+	std::vector<WordInfo> words;
+	Segmenter wordSegmenter;
+	uint32_t firstFrame = 0;
+	for (size_t i = 0; i < frames.size(); i++) {
+		auto segment = wordSegmenter.update(frames[i].rmsAmplitude);
+		if (segment.storeFeatureVector && segment.wordLength == 1) {
+			firstFrame = i;
+		}
+		if (segment.wordFinished) {
+			words.push_back(WordInfo{ firstFrame, uint32_t(segment.wordLength) });
+		}
+	}
+	return words;
+}
+
+}
+
+bool write(const char* path, const std::vector<featurelog::Frame>& frames) {
+	const std::vector<WordInfo> words = findWords(frames);
+
+	Header header;
+	std::memset(&header, 0, sizeof(header));
+	header.magic = magic;
+	header.version = version;
+	header.numColumns = numColumns;
+	header.numFrames = frames.size();
+	header.numWords = words.size();
+	header.wordOffset = sizeof(Header);
+	header.columnOffset = sizeof(Header) + words.size() * sizeof(WordInfo);
+	header.amplitudeThreshold = Segmenter::amplitudeThreshold;
+	header.maxQuietGap = Segmenter::maxQuietGap;
+	header.minWordLength = Segmenter::minWordLength;
+	header.maxWordLength = maxWords;
+
+	std::vector<float> columns(size_t(numColumns) * frames.size());
+	for (size_t i = 0; i < frames.size(); i++) {
+		columns[i] = frames[i].rmsAmplitude;
+		for (int k = 0; k < featurelog::numCoefficients; k++) {
+			columns[(1 + k) * frames.size() + i] = frames[i].cepstrum[k];
+		}
+	}
+
+	FILE* file = std::fopen(path, "wb");
+	if (file == nullptr) return false;
+	bool ok = std::fwrite(&header, sizeof(header), 1, file) == 1
+		&& std::fwrite(words.data(), sizeof(WordInfo), words.size(), file) == words.size()
+		&& std::fwrite(columns.data(), sizeof(float), columns.size(), file) == columns.size();
+	return std::fclose(file) == 0 && ok;
+}
+
+bool isSessionFile(const char* path) {
+	size_t length = std::strlen(path);
+	return length >= 4 && std::strcmp(path + length - 4, ".lps") == 0;
+}
+
+MappedSession::~MappedSession() {
+	close();
+}
+
+bool MappedSession::open(const char* path) {
+	close();
+	int fd = ::open(path, O_RDONLY);
+	if (fd < 0) return false;
+	struct stat status;
+	if (::fstat(fd, &status) != 0 || size_t(status.st_size) < sizeof(Header)) {
+		::close(fd);
+		return false;
+	}
+	void* address = ::mmap(nullptr, status.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+	::close(fd);
+	if (address == MAP_FAILED) return false;
+	bytes = static_cast<const uint8_t*>(address);
+	mappingSize = status.st_size;
+
+	const Header* candidate = reinterpret_cast<const Header*>(bytes);
+	const uint64_t wordsEnd = candidate->wordOffset + uint64_t(candidate->numWords) * sizeof(WordInfo);
+	const uint64_t columnsEnd = candidate->columnOffset + uint64_t(numColumns) * candidate->numFrames * sizeof(float);
+	bool valid = candidate->magic == magic
+		&& candidate->version == version
+		&& candidate->numColumns == numColumns
+		&& candidate->wordOffset % alignof(WordInfo) == 0 && candidate->wordOffset >= sizeof(Header) && wordsEnd <= mappingSize
+		&& candidate->columnOffset % alignof(float) == 0 && candidate->columnOffset >= sizeof(Header) && columnsEnd <= mappingSize;
+	if (!valid) {
+		close();
+		return false;
+	}
+	const WordInfo* table = reinterpret_cast<const WordInfo*>(bytes + candidate->wordOffset);
+	for (uint32_t i = 0; i < candidate->numWords; i++) {
+		if (table[i].numFrames == 0 || table[i].firstFrame > candidate->numFrames
+				|| table[i].numFrames > candidate->numFrames - table[i].firstFrame) {
+			close();
+			return false;
+		}
+	}
+	header = candidate;
+	words = table;
+	return true;
+}
+
+void MappedSession::close() {
+	if (bytes != nullptr) {
+		::munmap(const_cast<uint8_t*>(bytes), mappingSize);
+	}
+	bytes = nullptr;
+	mappingSize = 0;
+	header = nullptr;
+	words = nullptr;
+}
+
+featurelog::Frame MappedSession::frame(uint32_t idx) const {
+	featurelog::Frame frame;
+	frame.rmsAmplitude = column(0)[idx];
+	for (int k = 0; k < featurelog::numCoefficients; k++) {
+		frame.cepstrum[k] = column(1 + k)[idx];
+	}
+	return frame;
+}
+
+bool MappedSession::wordsCurrent(int maxWordLength) const {
+	return header->amplitudeThreshold == Segmenter::amplitudeThreshold
+		&& header->maxQuietGap == Segmenter::maxQuietGap
+		&& header->minWordLength == Segmenter::minWordLength
+		&& header->maxWordLength == maxWordLength;
+}
+
+}
@@ -0,0 +1,106 @@
+#pragma once
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+#include "feature_log.hpp"
+
+/**
+ * Binary session files (.lps), a columnar version of the feature logs with an
+ * index of the spoken words, mapped into memory instead of parsed.
+ *
+ * Layout, little endian, all offsets relative to the start of the file:
+ *
+ *     Header               40 bytes
+ *     WordInfo[numWords]    8 bytes each
+ *     columns              numColumns * numFrames floats, at columnOffset
+ *
+ * Column 0 holds the RMS amplitude of every frame, column 1 + k the k-th
+ * cepstrum coefficient, so frame i of column c is at
+ * columnOffset + (c * numFrames + i) * 4. The floats are stored exactly, a
+ * session converted from PCM keeps the front end's full precision.
+ *
+ * The word table is built with the WordSegmenter rules recorded in the
+ * header. Readers only use it while those match the current rules, otherwise
+ * they segment the columns again.
+ */
+namespace sessionfile {
+
+	constexpr uint32_t magic = 0x5353504c; // "LPSS"
+	constexpr uint16_t version = 1;
+	constexpr int numColumns = 1 + featurelog::numCoefficients;
+
+	struct Header {
+		uint32_t magic;
+		uint16_t version;
+		uint16_t numColumns;
+		uint32_t numFrames;
+		uint32_t numWords;
+		uint32_t wordOffset;
+		uint32_t columnOffset;
+		// Segmentation rules of the word table
+		float amplitudeThreshold;
+		uint16_t maxQuietGap;
+		uint16_t minWordLength;
+		uint16_t maxWordLength;
+		uint16_t reserved[3];
+	};
+	static_assert(sizeof(Header) == 40);
+
+	// The frames of a word as the firmware stores them
+	struct WordInfo {
+		uint32_t firstFrame;
+		uint32_t numFrames;
+	};
+	static_assert(sizeof(WordInfo) == 8);
+
+	// Segments the frames and writes them as a session file
+	bool write(const char* path, const std::vector<featurelog::Frame>& frames);
+
+	bool isSessionFile(const char* path);
+
+	// A session file mapped read-only into memory
+	class MappedSession {
+	public:
+		MappedSession() = default;
+		MappedSession(const MappedSession&) = delete;
+		MappedSession& operator=(const MappedSession&) = delete;
+		~MappedSession();
+
+		// Returns false if the file could not be mapped or is not a valid session
+		bool open(const char* path);
+		void close();
+
+		uint32_t numFrames() const {
+			return header->numFrames;
+		}
+
+		int numWords() const {
+			return header->numWords;
+		}
+
+		// numFrames() values of one column
+		const float* column(int idx) const {
+			return reinterpret_cast<const float*>(bytes + header->columnOffset) + size_t(idx) * header->numFrames;
+		}
+
+		const float* rmsAmplitude() const {
+			return column(0);
+		}
+
+		featurelog::Frame frame(uint32_t idx) const;
+
+		const WordInfo& word(int idx) const {
+			return words[idx];
+		}
+
+		// The word table was built with the current segmentation rules for this word length
+		bool wordsCurrent(int maxWordLength) const;
+
+	private:
+		const uint8_t* bytes = nullptr;
+		size_t mappingSize = 0;
+		const Header* header = nullptr;
+		const WordInfo* words = nullptr;
+	};
+}
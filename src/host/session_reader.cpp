@@ -0,0 +1,77 @@
+#include "session_reader.hpp"
+
+#include <algorithm>
+#include <cstring>
+
+#include <app/front_end.hpp>
+
+#include "audio_file.hpp"
+#include "resampler.hpp"
+#include "session_file.hpp"
+
+SessionReader::SessionReader() = default;
+
+SessionReader::~SessionReader() {
+	close();
+}
+
+bool SessionReader::open(const char* path, uint32_t pcmRate) {
+	close();
+	if (sessionfile::isSessionFile(path)) {
+		session = std::make_unique<sessionfile::MappedSession>();
+		if (session->open(path)) return true;
+		session.reset();
+		return false;
+	}
+	if (audio::isWav(path) || audio::isPcm(path)) {
+		audio::Clip clip;
+		bool ok = audio::isWav(path) ? audio::readWav(path, clip) : audio::readPcm(path, pcmRate != 0 ? pcmRate : sampleRate, clip);
+		if (!ok) return false;
+		if (clip.sampleRate == uint32_t(sampleRate)) {
+			pcm = std::move(clip.samples);
+		}
+		else {
+			PolyphaseResampler(clip.sampleRate, sampleRate).process(clip.samples, pcm);
+		}
+		frontEnd = std::make_unique<FrontEnd>();
+		return true;
+	}
+	file = std::fopen(path, "r");
+	return file != nullptr;
+}
+
+void SessionReader::close() {
+	if (file != nullptr) {
+		std::fclose(file);
+		file = nullptr;
+	}
+	frontEnd.reset();
+	pcm.clear();
+	pcmPosition = 0;
+	session.reset();
+	nextFrame = 0;
+}
+
+bool SessionReader::next(featurelog::Frame& frame) {
+	if (session != nullptr) {
+		if (nextFrame == session->numFrames()) return false;
+		frame = session->frame(nextFrame++);
+		return true;
+	}
+	if (frontEnd != nullptr) {
+		// A partial block at the end is dropped, like the ADC never completes it
+		if (pcm.size() - pcmPosition < size_t(windowStride)) return false;
+		frame.rmsAmplitude = frontEnd->addBlock(pcm.data() + pcmPosition, audio::pcmToAdc);
+		pcmPosition += windowStride;
+		frontEnd->computeCepstrum();
+		std::copy(frontEnd->cepstrum().begin(), frontEnd->cepstrum().end(), frame.cepstrum.begin());
+		// The mfcc stream does not include the 0th coefficient
+		frame.cepstrum[0] = 0;
+		return true;
+	}
+	if (file == nullptr) return false;
+	while (std::fgets(line, sizeof(line), file) != nullptr) {
+		if (featurelog::parseLine(line, frame)) return true;
+	}
+	return false;
+}
@@ -0,0 +1,49 @@
+#pragma once
+#include <cstdint>
+#include <cstdio>
+#include <memory>
+#include <vector>
+
+#include <app/parameters.hpp>
+
+#include "feature_log.hpp"
+
+template<typename Config>
+class BasicFrontEnd;
+namespace sessionfile {
+	class MappedSession;
+}
+
+/**
+ * Reads a recorded session one frame at a time.
+ *
+ * Feature logs (any extension but .pcm, .wav and .lps) are parsed line by
+ * line. Audio, WAV files or raw PCM (.pcm, 16 bit signed little endian mono),
+ * is loaded, resampled to sampleRate if needed and run block by block through
+ * the firmware's front end, so it yields the same frames the firmware would
+ * have printed on its mfcc stream. Binary session files (.lps, see
+ * session_file.hpp) are mapped and read column by column.
+ */
+class SessionReader {
+public:
+	SessionReader();
+	SessionReader(const SessionReader&) = delete;
+	SessionReader& operator=(const SessionReader&) = delete;
+	~SessionReader();
+
+	// pcmRate is the sample rate of raw PCM, 0 for sampleRate
+	bool open(const char* path, uint32_t pcmRate = 0);
+	void close();
+
+	// Returns false at the end of the session
+	bool next(featurelog::Frame& frame);
+
+private:
+	FILE* file = nullptr;
+	std::unique_ptr<BasicFrontEnd<Pipeline>> frontEnd;
+	std::vector<int16_t> pcm;
+	size_t pcmPosition = 0;
+	std::unique_ptr<sessionfile::MappedSession> session;
+	uint32_t nextFrame = 0;
+	char line[1024];
+};
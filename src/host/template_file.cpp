@@ -0,0 +1,40 @@
+#include "template_file.hpp"
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+MappedTemplateFile::~MappedTemplateFile() {
+	close();
+}
+
+bool MappedTemplateFile::open(const char* path, templatedb::Error& error) {
+	close();
+	error = templatedb::Error::None;
+
+	int fd = ::open(path, O_RDONLY);
+	if (fd < 0) return false;
+	struct stat status;
+	if (::fstat(fd, &status) != 0 || status.st_size == 0) {
+		::close(fd);
+		return false;
+	}
+	void* address = ::mmap(nullptr, status.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+	::close(fd);
+	if (address == MAP_FAILED) return false;
+
+	mapping = address;
+	mappingSize = status.st_size;
+	error = db.open(mapping, mappingSize);
+	return true;
+}
+
+void MappedTemplateFile::close() {
+	db.close();
+	if (mapping != nullptr) {
+		::munmap(mapping, mappingSize);
+		mapping = nullptr;
+		mappingSize = 0;
+	}
+}
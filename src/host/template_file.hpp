@@ -0,0 +1,31 @@
+#pragma once
+#include <cstddef>
+
+#include <app/template_db.hpp>
+
+/**
+ * A template database file mapped read-only into memory, so the host tools
+ * read the same bytes the firmware reads from flash.
+ */
+class MappedTemplateFile {
+public:
+	MappedTemplateFile() = default;
+	MappedTemplateFile(const MappedTemplateFile&) = delete;
+	MappedTemplateFile& operator=(const MappedTemplateFile&) = delete;
+	~MappedTemplateFile();
+
+	// Maps the file and opens the database in it, error is set if the file
+	// could be mapped but does not hold a valid database
+	bool open(const char* path, templatedb::Error& error);
+
+	void close();
+
+	const templatedb::Database& database() const {
+		return db;
+	}
+
+private:
+	void* mapping = nullptr;
+	size_t mappingSize = 0;
+	templatedb::Database db;
+};
@@ -0,0 +1,69 @@
+#include "template_writer.hpp"
+
+#include <cstdio>
+#include <cstring>
+
+namespace templatedb {
+
+bool pack(const std::vector<Template>& templates, std::vector<uint8_t>& database) {
+	const size_t tableEnd = sizeof(Header) + templates.size() * sizeof(TemplateInfo);
+	size_t totalSize = tableEnd;
+	for (const Template& entry : templates) {
+		if (entry.text.size() > maxTextLength) return false;
+		totalSize += entry.frames.size() * sizeof(FeatureVector);
+	}
+
+	database.assign(totalSize, 0);
+	uint8_t* const bytes = database.data();
+	uint32_t frameOffset = tableEnd;
+	for (size_t i = 0; i < templates.size(); i++) {
+		TemplateInfo info;
+		std::memset(&info, 0, sizeof(info));
+		std::strncpy(info.text, templates[i].text.c_str(), maxTextLength);
+		info.frameOffset = frameOffset;
+		info.numFrames = templates[i].frames.size();
+		std::memcpy(bytes + sizeof(Header) + i * sizeof(TemplateInfo), &info, sizeof(info));
+
+		const size_t frameBytes = templates[i].frames.size() * sizeof(FeatureVector);
+		std::memcpy(bytes + frameOffset, templates[i].frames.data(), frameBytes);
+		frameOffset += frameBytes;
+	}
+
+	Header header;
+	std::memset(&header, 0, sizeof(header));
+	header.magic = magic;
+	header.version = version;
+	header.featureVectorDim = featureVectorDim;
+	header.numTemplates = templates.size();
+	header.totalSize = totalSize;
+	header.checksum = crc32(bytes + sizeof(Header), totalSize - sizeof(Header));
+	std::memcpy(bytes, &header, sizeof(header));
+	return true;
+}
+
+bool writeBinary(const char* path, const std::vector<uint8_t>& database) {
+	FILE* file = std::fopen(path, "wb");
+	if (file == nullptr) return false;
+	bool ok = std::fwrite(database.data(), 1, database.size(), file) == database.size();
+	return std::fclose(file) == 0 && ok;
+}
+
+bool writeSource(const char* path, const std::vector<uint8_t>& database) {
+	FILE* file = std::fopen(path, "w");
+	if (file == nullptr) return false;
+	std::fprintf(file, "#include <cstdint>\n\n");
+	std::fprintf(file, "// Generated by template_builder\n");
+	std::fprintf(file, "__attribute__((section(\".templates\"), used, aligned(4)))\n");
+	std::fprintf(file, "extern const uint8_t defaultTemplateDatabase[] {\n");
+	for (size_t i = 0; i < database.size(); i += 16) {
+		std::fprintf(file, "\t");
+		for (size_t j = i; j < database.size() && j < i + 16; j++) {
+			std::fprintf(file, (j + 1 < i + 16 && j + 1 < database.size()) ? "0x%02x, " : "0x%02x,", database[j]);
+		}
+		std::fprintf(file, "\n");
+	}
+	std::fprintf(file, "};\n");
+	return std::fclose(file) == 0;
+}
+
+}
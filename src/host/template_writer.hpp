@@ -0,0 +1,27 @@
+#pragma once
+#include <cstdint>
+#include <string>
+#include <vector>
+
+#include <app/feature_vector.hpp>
+#include <app/template_db.hpp>
+
+/**
+ * Writes template databases in the format of app/template_db.hpp.
+ */
+namespace templatedb {
+
+	struct Template {
+		std::string text;
+		std::vector<FeatureVector> frames;
+	};
+
+	// Packs templates into a database, returns false if a text is too long
+	bool pack(const std::vector<Template>& templates, std::vector<uint8_t>& database);
+
+	// The raw database, for uploading and for the host tools
+	bool writeBinary(const char* path, const std::vector<uint8_t>& database);
+
+	// C++ source placing the database in the firmware's .templates flash section
+	bool writeSource(const char* path, const std::vector<uint8_t>& database);
+}
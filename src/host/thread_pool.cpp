@@ -0,0 +1,102 @@
+#include "thread_pool.hpp"
+
+#include <algorithm>
+
+namespace {
+
+// The pool and queue of the worker running on this thread
+thread_local const ThreadPool* currentPool = nullptr;
+thread_local int currentQueue = 0;
+
+}
+
+ThreadPool::ThreadPool(int threads) {
+	if (threads <= 0) {
+		threads = std::max(1u, std::thread::hardware_concurrency());
+	}
+	for (int i = 0; i < threads; i++) {
+		queues.push_back(std::make_unique<Queue>());
+	}
+	for (int i = 0; i < threads; i++) {
+		workers.emplace_back(&ThreadPool::work, this, i);
+	}
+}
+
+ThreadPool::~ThreadPool() {
+	wait();
+	{
+		std::lock_guard<std::mutex> lock(mutex);
+		stopping = true;
+	}
+	jobAvailable.notify_all();
+	for (std::thread& worker : workers) {
+		worker.join();
+	}
+}
+
+void ThreadPool::submit(std::function<void()> job) {
+	submit((currentPool == this) ? currentQueue : nextQueue++ % queues.size(), std::move(job));
+}
+
+void ThreadPool::submit(int worker, std::function<void()> job) {
+	const int idx = worker % queues.size();
+	pending += 1;
+	{
+		std::lock_guard<std::mutex> lock(queues[idx]->mutex);
+		queues[idx]->jobs.push_back(std::move(job));
+	}
+	queued += 1;
+	{
+		// Pairs with the check in work(), so a worker going to sleep sees the job
+		std::lock_guard<std::mutex> lock(mutex);
+	}
+	jobAvailable.notify_one();
+}
+
+void ThreadPool::wait() {
+	std::unique_lock<std::mutex> lock(mutex);
+	idle.wait(lock, [this] { return pending == 0; });
+}
+
+bool ThreadPool::take(int idx, std::function<void()>& job) {
+	{
+		Queue& own = *queues[idx];
+		std::lock_guard<std::mutex> lock(own.mutex);
+		if (!own.jobs.empty()) {
+			job = std::move(own.jobs.back());
+			own.jobs.pop_back();
+			return true;
+		}
+	}
+	for (size_t i = 1; i < queues.size(); i++) {
+		Queue& victim = *queues[(idx + i) % queues.size()];
+		std::lock_guard<std::mutex> lock(victim.mutex);
+		if (!victim.jobs.empty()) {
+			job = std::move(victim.jobs.front());
+			victim.jobs.pop_front();
+			return true;
+		}
+	}
+	return false;
+}
+
+void ThreadPool::work(int idx) {
+	currentPool = this;
+	currentQueue = idx;
+	std::function<void()> job;
+	while (true) {
+		if (take(idx, job)) {
+			queued -= 1;
+			job();
+			job = nullptr;
+			if (--pending == 0) {
+				std::lock_guard<std::mutex> lock(mutex);
+				idle.notify_all();
+			}
+			continue;
+		}
+		std::unique_lock<std::mutex> lock(mutex);
+		jobAvailable.wait(lock, [this] { return stopping || queued > 0; });
+		if (stopping && queued == 0) return;
+	}
+}
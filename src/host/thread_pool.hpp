@@ -0,0 +1,60 @@
+#pragma once
+#include <atomic>
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+/**
+ * Work-stealing thread pool for batch jobs of uneven size.
+ *
+ * Every worker has its own queue. Jobs submitted from outside are spread over
+ * the queues round robin, jobs submitted by a job go to its worker's queue.
+ * A worker takes its newest job first and, once its queue is empty, steals
+ * the oldest job of another worker, so long files do not leave the other
+ * workers idle at the end of a batch.
+ */
+class ThreadPool {
+public:
+	// 0 threads uses one per hardware thread
+	explicit ThreadPool(int threads = 0);
+	ThreadPool(const ThreadPool&) = delete;
+	ThreadPool& operator=(const ThreadPool&) = delete;
+	~ThreadPool();
+
+	void submit(std::function<void()> job);
+
+	// Queues the job at a given worker, so jobs working on the same data run
+	// on the same core while the load is even
+	void submit(int worker, std::function<void()> job);
+
+	// Blocks until all submitted jobs have finished
+	void wait();
+
+	int size() const {
+		return workers.size();
+	}
+
+private:
+	struct Queue {
+		std::mutex mutex;
+		std::deque<std::function<void()>> jobs;
+	};
+
+	std::vector<std::unique_ptr<Queue>> queues;
+	std::vector<std::thread> workers;
+	std::mutex mutex;
+	std::condition_variable jobAvailable;
+	std::condition_variable idle;
+	// Jobs waiting in a queue, and jobs not yet finished
+	std::atomic<int> queued{ 0 };
+	std::atomic<int> pending{ 0 };
+	std::atomic<unsigned> nextQueue{ 0 };
+	bool stopping = false;
+
+	void work(int idx);
+	bool take(int idx, std::function<void()>& job);
+};
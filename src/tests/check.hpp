@@ -0,0 +1,31 @@
+#pragma once
+#include <cstdio>
+
+/**
+ * The checks of the host tests in src/tests. A failed CHECK prints its
+ * condition and line and the test goes on; main returns test::result(),
+ * which is 1 if any check failed, for ctest.
+ */
+namespace test {
+
+	inline int failures = 0;
+
+	inline bool check(bool ok, const char* condition, const char* file, int line) {
+		if (!ok) {
+			std::fprintf(stderr, "%s:%d: FAIL: %s\n", file, line, condition);
+			failures++;
+		}
+		return ok;
+	}
+
+	inline int result() {
+		if (failures > 0) {
+			std::fprintf(stderr, "%d checks failed\n", failures);
+			return 1;
+		}
+		std::printf("ok\n");
+		return 0;
+	}
+}
+
+#define CHECK(condition) test::check((condition), #condition, __FILE__, __LINE__)
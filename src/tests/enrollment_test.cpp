@@ -0,0 +1,276 @@
+// Tests the enrollment log in flash (app/enrollment.hpp) on banks in memory
+// that fail on demand, as flash does when power is lost or a write goes
+// wrong: mounting blank and half-written banks, an append cut off before its
+// commit, compaction, forgetting across a remount, and a failed forget.
+//
+// Usage: enrollment_test
+
+#include <cstdint>
+#include <cstring>
+#include <vector>
+
+#include <app/enrollment.hpp>
+
+#include "check.hpp"
+
+namespace {
+
+// Flash in memory: erasing sets all bytes to 0xff, a word can only be
+// programmed once after that. programsLeft and eraseFails make the next
+// writes fail, to stop a sequence of writes where power would be lost.
+class MemoryFlash {
+public:
+	// Programs that still succeed, -1 for all
+	int programsLeft = -1;
+	bool eraseFails = false;
+
+	explicit MemoryFlash(uint32_t size) : words(size / 4, enrollment::erasedWord) {}
+
+	const uint8_t* data() const {
+		return reinterpret_cast<const uint8_t*>(words.data());
+	}
+
+	uint32_t size() const {
+		return words.size() * 4;
+	}
+
+	bool erase() {
+		if (eraseFails) return false;
+		std::fill(words.begin(), words.end(), enrollment::erasedWord);
+		return true;
+	}
+
+	bool program(uint32_t offset, uint32_t word) {
+		if (programsLeft == 0 || offset % 4 != 0 || offset >= size() || words[offset / 4] != enrollment::erasedWord) {
+			return false;
+		}
+		if (programsLeft > 0) programsLeft--;
+		words[offset / 4] = word;
+		return true;
+	}
+
+	void heal() {
+		programsLeft = -1;
+		eraseFails = false;
+	}
+
+	uint32_t word(uint32_t offset) const {
+		return words[offset / 4];
+	}
+
+private:
+	std::vector<uint32_t> words;
+};
+
+constexpr int dim = 4;
+constexpr int maxRecords = 8;
+constexpr uint32_t bankSize = 1024;
+
+using Log = enrollment::Log<MemoryFlash, dim, maxRecords>;
+using FeatureVector = Log::FeatureVector;
+
+// Frames whose values tell the template and frame they belong to
+std::vector<FeatureVector> makeWord(int id, int numFrames) {
+	std::vector<FeatureVector> frames(numFrames);
+	for (int i = 0; i < numFrames; i++) {
+		for (int j = 0; j < dim; j++) {
+			frames[i][j] = id * 1000 + i * 10 + j;
+		}
+	}
+	return frames;
+}
+
+enrollment::Error append(Log& log, const char* text, int id, int numFrames) {
+	const std::vector<FeatureVector> frames = makeWord(id, numFrames);
+	return log.append(text, frames.data(), numFrames);
+}
+
+bool hasWord(const Log& log, int idx, const char* text, int id, int numFrames) {
+	if (std::strcmp(log.text(idx), text) != 0 || log.numFrames(idx) != numFrames) return false;
+	const std::vector<FeatureVector> frames = makeWord(id, numFrames);
+	return std::memcmp(log.frames(idx), frames.data(), numFrames * sizeof(FeatureVector)) == 0;
+}
+
+// The writes of an append: its header up to the committed word, then its frames
+int programsBeforeCommit(int numFrames) {
+	return offsetof(enrollment::RecordHeader, committed) / 4 + numFrames * dim;
+}
+
+uint32_t recordLength(int numFrames) {
+	return sizeof(enrollment::RecordHeader) + numFrames * sizeof(FeatureVector);
+}
+
+void checkBlank() {
+	MemoryFlash bankA(bankSize), bankB(bankSize);
+	Log log(bankA, bankB);
+	CHECK(log.mount());
+	CHECK(log.size() == 0);
+	CHECK(log.generation() == 1);
+	CHECK(log.bytesFree() == bankSize - sizeof(enrollment::BankHeader));
+	CHECK(bankA.word(0) == enrollment::bankMagic);
+
+	// Formatted once, a remount finds the same empty log
+	Log again(bankA, bankB);
+	CHECK(again.mount());
+	CHECK(again.size() == 0 && again.generation() == 1);
+}
+
+void checkInterruptedAppend() {
+	MemoryFlash bankA(bankSize), bankB(bankSize);
+	{
+		Log log(bankA, bankB);
+		CHECK(log.mount());
+		CHECK(append(log, "ja", 1, 5) == enrollment::Error::None);
+		// Power is lost after the last frame, before the committed word
+		bankA.programsLeft = programsBeforeCommit(3);
+		CHECK(append(log, "nein", 2, 3) == enrollment::Error::FlashError);
+		CHECK(log.size() == 1);
+	}
+	bankA.heal();
+
+	Log log(bankA, bankB);
+	CHECK(log.mount());
+	CHECK(log.size() == 1);
+	CHECK(hasWord(log, 0, "ja", 1, 5));
+	// The uncommitted record keeps its space until the next compaction
+	const uint32_t used = sizeof(enrollment::BankHeader) + recordLength(5) + recordLength(3);
+	CHECK(log.bytesFree() == bankSize - used);
+
+	CHECK(append(log, "nein", 3, 3) == enrollment::Error::None);
+	Log remounted(bankA, bankB);
+	CHECK(remounted.mount());
+	CHECK(remounted.size() == 2);
+	CHECK(hasWord(remounted, 0, "ja", 1, 5) && hasWord(remounted, 1, "nein", 3, 3));
+}
+
+// Fills the bank of a fresh log with a live and forgotten records, returns
+// the bytes live records take
+uint32_t fillWithForgotten(Log& log) {
+	CHECK(log.mount());
+	CHECK(append(log, "keep", 1, 4) == enrollment::Error::None);
+	int id = 2;
+	while (log.bytesFree() >= recordLength(10)) {
+		CHECK(append(log, "drop", id++, 10) == enrollment::Error::None);
+		CHECK(log.forget("drop") == 1);
+	}
+	CHECK(log.size() == 1);
+	return recordLength(4);
+}
+
+void checkCompaction() {
+	MemoryFlash bankA(bankSize), bankB(bankSize);
+	Log log(bankA, bankB);
+	const uint32_t live = fillWithForgotten(log);
+	const uint32_t generation = log.generation();
+	CHECK(log.frames(0) > reinterpret_cast<const FeatureVector*>(bankA.data()));
+
+	// Does not fit any more, the live record moves to bank B
+	CHECK(append(log, "neu", 50, 10) == enrollment::Error::None);
+	CHECK(log.generation() == generation + 1);
+	CHECK(log.size() == 2);
+	CHECK(hasWord(log, 0, "keep", 1, 4) && hasWord(log, 1, "neu", 50, 10));
+	CHECK(reinterpret_cast<const uint8_t*>(log.frames(0)) > bankB.data());
+	CHECK(log.bytesFree() == bankSize - sizeof(enrollment::BankHeader) - live - recordLength(10));
+	// The old bank is erased
+	CHECK(bankA.word(0) == enrollment::erasedWord);
+
+	Log remounted(bankA, bankB);
+	CHECK(remounted.mount());
+	CHECK(remounted.generation() == generation + 1);
+	CHECK(remounted.size() == 2);
+	CHECK(hasWord(remounted, 0, "keep", 1, 4) && hasWord(remounted, 1, "neu", 50, 10));
+}
+
+void checkInterruptedCompaction() {
+	// Before the new bank's header is written: the old bank stays active
+	{
+		MemoryFlash bankA(bankSize), bankB(bankSize);
+		Log log(bankA, bankB);
+		fillWithForgotten(log);
+		const uint32_t generation = log.generation();
+		// The live record is copied, the header's two words are not
+		bankB.programsLeft = recordLength(4) / 4;
+		CHECK(append(log, "neu", 50, 10) == enrollment::Error::FlashError);
+		bankB.heal();
+
+		Log remounted(bankA, bankB);
+		CHECK(remounted.mount());
+		CHECK(remounted.generation() == generation);
+		CHECK(remounted.size() == 1 && hasWord(remounted, 0, "keep", 1, 4));
+		// The next compaction erases the half-written bank first
+		CHECK(append(remounted, "neu", 50, 10) == enrollment::Error::None);
+		CHECK(remounted.generation() == generation + 1);
+		CHECK(remounted.size() == 2);
+	}
+	// After it, before the old bank is erased: both are valid, the newer wins
+	{
+		MemoryFlash bankA(bankSize), bankB(bankSize);
+		Log log(bankA, bankB);
+		fillWithForgotten(log);
+		const uint32_t generation = log.generation();
+		bankA.eraseFails = true;
+		CHECK(append(log, "neu", 50, 10) == enrollment::Error::FlashError);
+		bankA.heal();
+		CHECK(bankA.word(0) == enrollment::bankMagic && bankB.word(0) == enrollment::bankMagic);
+
+		Log remounted(bankA, bankB);
+		CHECK(remounted.mount());
+		CHECK(remounted.generation() == generation + 1);
+		CHECK(remounted.size() == 1 && hasWord(remounted, 0, "keep", 1, 4));
+		CHECK(bankA.word(0) == enrollment::erasedWord);
+	}
+}
+
+void checkForget() {
+	MemoryFlash bankA(bankSize), bankB(bankSize);
+	{
+		Log log(bankA, bankB);
+		CHECK(log.mount());
+		CHECK(append(log, "ja", 1, 3) == enrollment::Error::None);
+		CHECK(append(log, "nein", 2, 3) == enrollment::Error::None);
+		CHECK(append(log, "ja", 3, 4) == enrollment::Error::None);
+		CHECK(log.forget("vielleicht") == 0);
+		CHECK(log.forget("ja") == 2);
+		CHECK(log.size() == 1 && hasWord(log, 0, "nein", 2, 3));
+	}
+	Log log(bankA, bankB);
+	CHECK(log.mount());
+	CHECK(log.size() == 1 && hasWord(log, 0, "nein", 2, 3));
+}
+
+void checkFailedForget() {
+	MemoryFlash bankA(bankSize), bankB(bankSize);
+	{
+		Log log(bankA, bankB);
+		CHECK(log.mount());
+		CHECK(append(log, "ja", 1, 3) == enrollment::Error::None);
+		CHECK(append(log, "nein", 2, 3) == enrollment::Error::None);
+		CHECK(append(log, "ja", 3, 4) == enrollment::Error::None);
+
+		// The first mark is written, the second fails
+		bankA.programsLeft = 1;
+		CHECK(log.forget("ja") == -1);
+		CHECK(log.size() == 2);
+		CHECK(hasWord(log, 0, "nein", 2, 3) && hasWord(log, 1, "ja", 3, 4));
+		bankA.heal();
+	}
+	// The RAM index matched flash
+	Log log(bankA, bankB);
+	CHECK(log.mount());
+	CHECK(log.size() == 2);
+	CHECK(hasWord(log, 0, "nein", 2, 3) && hasWord(log, 1, "ja", 3, 4));
+	CHECK(log.forget("ja") == 1);
+	CHECK(log.size() == 1);
+}
+
+}
+
+int main() {
+	checkBlank();
+	checkInterruptedAppend();
+	checkCompaction();
+	checkInterruptedCompaction();
+	checkForget();
+	checkFailedForget();
+	return test::result();
+}
@@ -0,0 +1,162 @@
+// Tests the error bounds of the fast log2 of common/fast_math.hpp for every
+// degree.
+//
+// log2<Degree>(x) must be within Log2Polynomial<Degree>::maxError of log2(x)
+// plus half an ulp of the result, for the rounding of the exponent's sum. It
+// is checked for every normal float, on all cores. log2Q16<Degree>(x) must be
+// within maxError plus one Q16 step, checked for every x below 2^24 and a
+// sample of the larger ones.
+//
+// For each degree the report gives the largest error, the limit it is held
+// to at the point where it is closest to its limit, and that margin.
+//
+// Usage: fast_log2_test [--exponents first last]
+//     first and last are biased exponents, 1 to 254 for every normal float
+
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <cmath>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <thread>
+#include <vector>
+
+#include <common/fast_math.hpp>
+
+#include "check.hpp"
+
+namespace {
+
+struct FloatErrors {
+	double maxError = 0;
+	// Where the error comes closest to its limit
+	double worstError = 0;
+	double worstLimit = 1;
+
+	double margin() const {
+		return worstLimit - worstError;
+	}
+
+	void add(double error, double limit) {
+		maxError = std::max(maxError, error);
+		if (limit - error < margin()) {
+			worstError = error;
+			worstLimit = limit;
+		}
+	}
+
+	void add(const FloatErrors& other) {
+		maxError = std::max(maxError, other.maxError);
+		if (other.margin() < margin()) {
+			worstError = other.worstError;
+			worstLimit = other.worstLimit;
+		}
+	}
+};
+
+// log2 of the mantissas 1 + m / 2^23, a float's log2 is its unbiased
+// exponent plus that of its mantissa
+std::vector<double> mantissaLog2() {
+	std::vector<double> result(1u << 23);
+	for (uint32_t mantissa = 0; mantissa < result.size(); mantissa++) {
+		result[mantissa] = std::log2(1 + std::ldexp(double(mantissa), -23));
+	}
+	return result;
+}
+
+template<int Degree>
+FloatErrors checkExponent(uint32_t exponent, const std::vector<double>& reference) {
+	const double bound = fastmath::Log2Polynomial<Degree>::maxError;
+	const double unbiased = double(exponent) - 127;
+	std::array<double, 129> halfUlps;
+	for (int i = 0; i < int(halfUlps.size()); i++) {
+		halfUlps[i] = std::ldexp(1.0, i - 24);
+	}
+	FloatErrors errors;
+	for (uint32_t mantissa = 0; mantissa < (1u << 23); mantissa++) {
+		const uint32_t bits = (exponent << 23) | mantissa;
+		float x;
+		std::memcpy(&x, &bits, sizeof(x));
+		const float value = fastmath::log2<Degree>(x);
+		const double error = std::abs(double(value) - (unbiased + reference[mantissa]));
+		// Half an ulp of the result for the rounding of the exponent's sum, by
+		// the result's exponent, that of 1 for results below 1
+		uint32_t valueBits;
+		std::memcpy(&valueBits, &value, sizeof(value));
+		const int valueExponent = std::max(int((valueBits >> 23) & 0xff) - 127, 0);
+		errors.add(error, bound + halfUlps[valueExponent]);
+	}
+	return errors;
+}
+
+template<int Degree>
+bool checkLog2(int firstExponent, int lastExponent, const std::vector<double>& reference) {
+	const double bound = fastmath::Log2Polynomial<Degree>::maxError;
+
+	std::atomic<int> nextExponent(firstExponent);
+	std::vector<FloatErrors> threadErrors(std::max(1u, std::thread::hardware_concurrency()));
+	std::vector<std::thread> threads;
+	for (FloatErrors& errors : threadErrors) {
+		threads.emplace_back([&] {
+			for (int exponent = nextExponent++; exponent <= lastExponent; exponent = nextExponent++) {
+				errors.add(checkExponent<Degree>(exponent, reference));
+			}
+		});
+	}
+	for (std::thread& thread : threads) {
+		thread.join();
+	}
+	FloatErrors errors;
+	for (const FloatErrors& threadError : threadErrors) {
+		errors.add(threadError);
+	}
+
+	double maxFixedError = 0;
+	auto checkFixed = [&](uint32_t x) {
+		const double error = std::abs(fastmath::log2Q16<Degree>(x) / 65536.0 - std::log2(double(x)));
+		maxFixedError = std::max(maxFixedError, error);
+	};
+	for (uint32_t x = 1; x < (1u << 24); x++) {
+		checkFixed(x);
+	}
+	for (int shift = 1; shift <= 8; shift++) {
+		for (uint32_t x = 1u << 23; x < (1u << 24); x += 7) {
+			checkFixed(x << shift);
+		}
+	}
+	const double fixedLimit = bound + 1.0 / 65536;
+
+	const bool ok = errors.margin() >= 0 && maxFixedError <= fixedLimit;
+	std::printf("log2 degree %d: max error %.3g; closest to its limit %.3g against %.3g (bound %.3g + rounding %.3g), "
+		"margin %.3g; Q16 max error %.3g, limit %.3g; %s\n",
+		Degree, errors.maxError, errors.worstError, errors.worstLimit, bound, errors.worstLimit - bound, errors.margin(),
+		maxFixedError, fixedLimit, ok ? "ok" : "FAILED");
+	return ok;
+}
+
+}
+
+int main(int argc, char** argv) {
+	// Every normal float
+	int firstExponent = 1;
+	int lastExponent = 254;
+	if (argc == 4 && std::strcmp(argv[1], "--exponents") == 0) {
+		firstExponent = std::max(1, std::atoi(argv[2]));
+		lastExponent = std::min(254, std::atoi(argv[3]));
+	}
+	else if (argc != 1) {
+		std::fprintf(stderr, "usage: %s [--exponents first last]\n", argv[0]);
+		return 1;
+	}
+
+	const std::vector<double> reference = mantissaLog2();
+	CHECK(checkLog2<3>(firstExponent, lastExponent, reference));
+	CHECK(checkLog2<4>(firstExponent, lastExponent, reference));
+	CHECK(checkLog2<5>(firstExponent, lastExponent, reference));
+	CHECK(checkLog2<6>(firstExponent, lastExponent, reference));
+	CHECK(checkLog2<7>(firstExponent, lastExponent, reference));
+	return test::result();
+}
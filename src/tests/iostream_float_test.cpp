@@ -0,0 +1,158 @@
+// Tests the table-driven float formatting of modm's IOStream
+// (modm/src/modm/io/iostream_float.cpp) that the firmware's telemetry uses.
+// On the host, IOStream formats floats with snprintf, so the test calls the
+// target's formatters directly.
+//
+// Scientific output of random floats of every exponent, subnormals included,
+// and fixed output of the range the telemetry prints must parse back within
+// half a unit of the last printed digit, plus the float rounding of the
+// scaling. A few values are checked character by character: zero, rounding
+// that carries into a new digit and fixed values too large for 32 bits.
+//
+// Usage: iostream_float_test
+
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <random>
+#include <string>
+
+#include <modm/io/iostream.hpp>
+
+#include "check.hpp"
+
+namespace {
+
+class StringDevice : public modm::IODevice {
+public:
+	std::string text;
+
+	void write(char c) override {
+		text += c;
+	}
+
+	void flush() override {
+	}
+
+	bool read(char&) override {
+		return false;
+	}
+};
+
+// The target's formatters of non-negative values, writeFloat adds the sign
+class FloatStream : public modm::IOStream {
+public:
+	FloatStream() : modm::IOStream(device) {
+	}
+
+	std::string scientific(float value, uint8_t precision) {
+		device.text.clear();
+		setFloatFormat(FloatFormat::Scientific, precision);
+		writeFloatScientific(value);
+		return device.text;
+	}
+
+	std::string fixed(float value, uint8_t precision) {
+		device.text.clear();
+		setFloatFormat(FloatFormat::Fixed, precision);
+		writeFloatFixed(value);
+		return device.text;
+	}
+
+private:
+	StringDevice device;
+};
+
+float floatFromBits(uint32_t bits) {
+	float value;
+	std::memcpy(&value, &bits, sizeof(value));
+	return value;
+}
+
+// The float roundings of scaling a value to its digits: the table's power
+// of ten and the product, and for the values below 1e-20 also lifting them
+// by 1e20 first. Each is at most 2^-24 relative.
+double scalingError(float value, int roundings) {
+	return roundings * std::ldexp(double(value), -24);
+}
+
+// The printed value of value must be within the limit of it
+bool checkRoundTrip(const std::string& text, float value, double limit) {
+	char* end;
+	const double parsed = std::strtod(text.c_str(), &end);
+	const bool ok = *end == '\0' && std::abs(parsed - double(value)) <= limit;
+	if (!ok) {
+		std::printf("%.9g printed as %s\n", double(value), text.c_str());
+	}
+	return ok;
+}
+
+void checkScientific(FloatStream& stream, std::mt19937& random, int count) {
+	// Every finite positive float, subnormals included
+	std::uniform_int_distribution<uint32_t> bits(1, 0x7f7fffff);
+	for (uint8_t precision = 0; precision <= modm::IOStream::maxFloatPrecision; precision++) {
+		int failures = 0;
+		for (int i = 0; i < count; i++) {
+			const float value = floatFromBits(bits(random));
+			const int exponent = int(std::floor(std::log10(double(value))));
+			const double halfUnit = 0.5 * std::pow(10.0, exponent - precision);
+			failures += !checkRoundTrip(stream.scientific(value, precision), value,
+				halfUnit + scalingError(value, value < 1e-20f ? 4 : 2));
+		}
+		std::printf("scientific precision %d: %d of %d values wrong\n", precision, failures, count);
+		CHECK(failures == 0);
+	}
+}
+
+void checkFixed(FloatStream& stream, std::mt19937& random, int count) {
+	// The range of the features and spectra in the telemetry
+	std::uniform_real_distribution<float> values(0, 1000);
+	for (uint8_t precision = 0; precision <= modm::IOStream::maxFloatPrecision; precision++) {
+		int failures = 0;
+		for (int i = 0; i < count; i++) {
+			const float value = values(random);
+			const double halfUnit = 0.5 * std::pow(10.0, -precision);
+			// The powers of ten up to 10^6 are exact, only the product rounds
+			failures += !checkRoundTrip(stream.fixed(value, precision), value, halfUnit + scalingError(value, 1));
+		}
+		std::printf("fixed precision %d: %d of %d values wrong\n", precision, failures, count);
+		CHECK(failures == 0);
+	}
+}
+
+void checkExact(FloatStream& stream) {
+	CHECK(stream.scientific(0, 5) == "0.00000e+00");
+	CHECK(stream.scientific(1, 0) == "1e+00");
+	CHECK(stream.scientific(12345.678f, 3) == "1.235e+04");
+	CHECK(stream.scientific(0.000123f, 2) == "1.23e-04");
+	// Rounding carries into a new digit
+	CHECK(stream.scientific(9.9999999f, 5) == "1.00000e+01");
+	CHECK(stream.scientific(0.99999f, 2) == "1.00e+00");
+	CHECK(stream.scientific(3.4028235e38f, 5) == "3.40282e+38");
+	CHECK(stream.scientific(1e-40f, 1) == "1.0e-40");
+
+	CHECK(stream.fixed(0, 5) == "0.00000");
+	CHECK(stream.fixed(1.5f, 0) == "2");
+	CHECK(stream.fixed(2.25f, 1) == "2.3");
+	CHECK(stream.fixed(0.000004f, 5) == "0.00000");
+	CHECK(stream.fixed(0.000006f, 5) == "0.00001");
+	CHECK(stream.fixed(123.456f, 2) == "123.46");
+	CHECK(stream.fixed(9.9999999f, 3) == "10.000");
+	// Too large for the 32 bit fixed point, printed in scientific notation
+	CHECK(stream.fixed(5e9f, 2) == "5.00e+09");
+	CHECK(stream.fixed(1e5f, 6) == "1.000000e+05");
+}
+
+}
+
+int main() {
+	FloatStream stream;
+	std::mt19937 random(1);
+	checkExact(stream);
+	checkScientific(stream, random, 1'000'000);
+	checkFixed(stream, random, 1'000'000);
+	return test::result();
+}
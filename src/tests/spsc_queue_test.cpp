@@ -0,0 +1,102 @@
+// Tests SpscQueue (common/spsc_queue.hpp), the hand-off between the ADC
+// interrupt, PendSV and thread mode: full against empty, the counters
+// wrapping past 2^32, and a producer and a consumer thread racing, which the
+// host build also runs under ThreadSanitizer as spsc_queue_test_tsan.
+//
+// Usage: spsc_queue_test
+
+#include <cstdint>
+#include <thread>
+
+#include <common/spsc_queue.hpp>
+
+#include "check.hpp"
+
+namespace {
+
+constexpr int capacity = 8;
+
+// Both halves must match, so a torn copy shows
+struct Item {
+	uint32_t value;
+	uint32_t inverse;
+};
+
+Item makeItem(uint32_t value) {
+	return { value, ~value };
+}
+
+// Fills and drains a queue whose counters start at start
+void checkFillAndDrain(uint32_t start) {
+	SpscQueue<uint32_t, capacity> queue;
+	queue.clear(start);
+	uint32_t item;
+	CHECK(queue.empty() && !queue.full() && queue.size() == 0);
+	CHECK(!queue.pop(item));
+
+	// A few rounds, so the counters of a start below 2^32 cross it
+	for (uint32_t round = 0; round < 4; round++) {
+		for (uint32_t i = 0; i < capacity; i++) {
+			CHECK(queue.push(round * capacity + i));
+			CHECK(queue.size() == int(i + 1));
+		}
+		CHECK(queue.full() && !queue.empty());
+		CHECK(!queue.push(12345));
+		CHECK(queue.size() == capacity);
+
+		for (uint32_t i = 0; i < capacity; i++) {
+			CHECK(queue.pop(item) && item == round * capacity + i);
+		}
+		CHECK(queue.empty() && !queue.full());
+		CHECK(!queue.pop(item));
+	}
+
+	// Interleaved, one behind
+	CHECK(queue.push(1));
+	for (uint32_t i = 2; i < 3 * capacity; i++) {
+		CHECK(queue.push(i));
+		CHECK(queue.pop(item) && item == i - 1);
+		CHECK(queue.size() == 1);
+	}
+}
+
+// The consumer must see every item once, in order and whole
+void checkThreads(uint32_t start, uint32_t count) {
+	static SpscQueue<Item, capacity> queue;
+	queue.clear(start);
+
+	std::thread producer([count] {
+		for (uint32_t i = 0; i < count; i++) {
+			while (!queue.push(makeItem(i))) {
+				std::this_thread::yield();
+			}
+		}
+	});
+
+	uint32_t expected = 0;
+	bool inOrder = true;
+	while (expected < count) {
+		Item item;
+		if (!queue.pop(item)) {
+			std::this_thread::yield();
+			continue;
+		}
+		inOrder = inOrder && item.value == expected && item.inverse == ~expected;
+		expected++;
+	}
+	producer.join();
+	CHECK(inOrder);
+	CHECK(queue.empty());
+}
+
+}
+
+int main() {
+	checkFillAndDrain(0);
+	checkFillAndDrain(UINT32_MAX - 2);
+	checkFillAndDrain(UINT32_MAX - capacity);
+
+	checkThreads(0, 200'000);
+	checkThreads(UINT32_MAX - 100'000, 200'000);
+	return test::result();
+}
@@ -0,0 +1,185 @@
+// Tests the telemetry command parser (app/telemetry.hpp) with scripted
+// input, fed one character at a time as from the UART: every command and
+// result, the streams' decimation and one-shot dumps, malformed commands,
+// and lines and words longer than the parser keeps.
+//
+// Usage: telemetry_test
+
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <string>
+#include <vector>
+
+#include <app/telemetry.hpp>
+
+#include "check.hpp"
+
+namespace {
+
+using telemetry::Control;
+using telemetry::Result;
+using telemetry::Stream;
+
+// The results of every complete line of script, None for the blank ones
+std::vector<Result> feed(Control& control, const std::string& script) {
+	std::vector<Result> results;
+	for (char c : script) {
+		const Result result = control.receive(c);
+		if (result != Result::None) {
+			results.push_back(result);
+		}
+		else if (c == '\n' || c == '\r') {
+			results.push_back(Result::None);
+		}
+	}
+	return results;
+}
+
+Result send(Control& control, const std::string& line) {
+	const std::vector<Result> results = feed(control, line + "\n");
+	return results.size() == 1 ? results[0] : Result::None;
+}
+
+// Which of the next frames the stream is printed on, as a string of 0 and 1
+std::string schedule(Control& control, Stream stream, int frames) {
+	std::string result;
+	for (int i = 0; i < frames; i++) {
+		result += control.due(stream) ? '1' : '0';
+	}
+	return result;
+}
+
+void checkDefaults() {
+	Control control;
+	CHECK(control.wanted(Stream::Mfcc) && control.wanted(Stream::Stats) && control.wanted(Stream::Scores));
+	CHECK(!control.wanted(Stream::Raw) && !control.wanted(Stream::Spectrum) && !control.wanted(Stream::Profile));
+	CHECK(schedule(control, Stream::Mfcc, 3) == "111");
+	CHECK(schedule(control, Stream::Raw, 3) == "000");
+}
+
+void checkStreams() {
+	Control control;
+	CHECK(send(control, "on spec") == Result::Ok);
+	CHECK(control.wanted(Stream::Spectrum));
+	CHECK(schedule(control, Stream::Spectrum, 3) == "111");
+
+	CHECK(send(control, "off mfcc") == Result::Ok);
+	CHECK(!control.wanted(Stream::Mfcc));
+	CHECK(schedule(control, Stream::Mfcc, 3) == "000");
+
+	// every also enables the stream, its first print is the n-th frame
+	CHECK(send(control, "every raw 3") == Result::Ok);
+	CHECK(schedule(control, Stream::Raw, 7) == "0010010");
+	CHECK(send(control, "every raw 0") == Result::Ok);
+	CHECK(schedule(control, Stream::Raw, 3) == "111");
+
+	// once prints on the next frame only, also when the stream is off, and
+	// restarts the decimation of an enabled one
+	CHECK(send(control, "once prof") == Result::Ok);
+	CHECK(control.wanted(Stream::Profile));
+	CHECK(schedule(control, Stream::Profile, 3) == "100");
+	CHECK(!control.wanted(Stream::Profile));
+	CHECK(send(control, "every stat 4") == Result::Ok);
+	CHECK(schedule(control, Stream::Stats, 2) == "00");
+	CHECK(send(control, "once stat") == Result::Ok);
+	CHECK(schedule(control, Stream::Stats, 5) == "10001");
+
+	CHECK(send(control, "off all") == Result::Ok);
+	for (int i = 0; i < telemetry::numStreams; i++) {
+		CHECK(!control.wanted(static_cast<Stream>(i)));
+	}
+	CHECK(send(control, "every all 2") == Result::Ok);
+	for (int i = 0; i < telemetry::numStreams; i++) {
+		CHECK(schedule(control, static_cast<Stream>(i), 4) == "0101");
+	}
+}
+
+void checkRequests() {
+	Control control;
+	CHECK(send(control, "upload 8192") == Result::Upload);
+	CHECK(control.uploadSize() == 8192);
+	CHECK(send(control, "upload 4294967295") == Result::Upload);
+	CHECK(control.uploadSize() == UINT32_MAX);
+
+	CHECK(send(control, "enroll ja") == Result::Enroll);
+	CHECK(std::strcmp(control.commandText(), "ja") == 0);
+	CHECK(send(control, "forget nein") == Result::Forget);
+	CHECK(std::strcmp(control.commandText(), "nein") == 0);
+	// The longest word that fits
+	CHECK(send(control, "enroll abcdefghijklmno") == Result::Enroll);
+	CHECK(std::strcmp(control.commandText(), "abcdefghijklmno") == 0);
+}
+
+void checkErrors() {
+	Control control;
+	const char* badLines[] = {
+		"on",
+		"on nothing",
+		"blink mfcc",
+		"on mfcc 3",
+		"once all now",
+		"every raw",
+		"every raw x",
+		"every raw -1",
+		"every raw 65536",
+		"upload",
+		"upload 12k",
+		"upload 4294967296",
+		"upload 99999999999",
+		"upload 10 20",
+		"enroll",
+		"enroll two words",
+		"forget",
+		"ON mfcc",
+	};
+	for (const char* line : badLines) {
+		if (!CHECK(send(control, line) == Result::Error)) {
+			std::fprintf(stderr, "    line \"%s\"\n", line);
+		}
+	}
+	// Nothing changed, nothing was requested
+	CHECK(control.wanted(Stream::Mfcc) && !control.wanted(Stream::Raw));
+	CHECK(control.uploadSize() == 0);
+	CHECK(control.commandText()[0] == '\0');
+
+	// A word one longer than the parser keeps
+	CHECK(send(control, "forget abcdefghijklmnop") == Result::Error);
+	CHECK(control.commandText()[0] == '\0');
+}
+
+void checkLines() {
+	Control control;
+	// Blank lines and CR LF line ends are skipped, spaces around words too
+	CHECK(feed(control, "\n\r\n") == std::vector<Result>({ Result::None, Result::None, Result::None }));
+	CHECK(feed(control, "  on   raw  \r\noff raw\roff spec\n")
+		== std::vector<Result>({ Result::Ok, Result::None, Result::Ok, Result::Ok }));
+	CHECK(!control.wanted(Stream::Raw));
+
+	// The longest line that fits, 31 characters
+	const std::string longest = "every spec                    9";
+	CHECK(longest.size() == 31);
+	CHECK(send(control, longest) == Result::Ok);
+	CHECK(schedule(control, Stream::Spectrum, 9) == "000000001");
+
+	// One character more is dropped as a whole, and the next line parses again
+	CHECK(send(control, "every spec                    10") == Result::Error);
+	CHECK(schedule(control, Stream::Spectrum, 9) == "000000001");
+	const std::string overlong(200, 'x');
+	CHECK(feed(control, overlong + "\non raw\n") == std::vector<Result>({ Result::Error, Result::Ok }));
+	CHECK(control.wanted(Stream::Raw));
+	// A command in the kept part of an overlong line does not run
+	CHECK(send(control, "off raw" + std::string(40, ' ')) == Result::Error);
+	CHECK(control.wanted(Stream::Raw));
+}
+
+}
+
+int main() {
+	checkDefaults();
+	checkStreams();
+	checkRequests();
+	checkErrors();
+	checkLines();
+	return test::result();
+}
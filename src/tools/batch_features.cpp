@@ -0,0 +1,139 @@
+// Runs the firmware's front end over a corpus of audio files.
+//
+// Collects all .wav and .pcm files in the given files and directories,
+// resamples them to the pipeline's sample rate and computes their frames in
+// parallel on a work-stealing thread pool. With -o every clip is written as a
+// binary session file (.lps), mirroring the directory structure, for the other
+// host tools. Reports the throughput in files per second and times real time.
+//
+// Usage: batch_features [--threads n] [--pcm-rate hz] [-o output directory] <file or directory>...
+
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <filesystem>
+#include <string>
+#include <vector>
+
+#include <app/parameters.hpp>
+#include <host/audio_file.hpp>
+#include <host/session_file.hpp>
+#include <host/session_reader.hpp>
+#include <host/thread_pool.hpp>
+
+namespace fs = std::filesystem;
+
+namespace {
+
+struct Input {
+	fs::path path;
+	// Where the session file goes, empty without -o
+	fs::path output;
+};
+
+bool isAudio(const fs::path& path) {
+	return audio::isWav(path.c_str()) || audio::isPcm(path.c_str());
+}
+
+bool collectInputs(const char* argument, const char* outputDirectory, std::vector<Input>& inputs) {
+	std::error_code error;
+	const fs::path root(argument);
+	auto add = [&](const fs::path& path, const fs::path& relative) {
+		Input input{ path, {} };
+		if (outputDirectory != nullptr) {
+			input.output = (fs::path(outputDirectory) / relative).replace_extension(".lps");
+		}
+		inputs.push_back(input);
+	};
+
+	if (!fs::is_directory(root, error)) {
+		if (!fs::exists(root, error)) return false;
+		add(root, root.filename());
+		return true;
+	}
+	for (fs::recursive_directory_iterator it(root, error), end; it != end; it.increment(error)) {
+		if (error) return false;
+		if (it->is_regular_file(error) && isAudio(it->path())) {
+			add(it->path(), fs::relative(it->path(), root, error));
+		}
+	}
+	return !error;
+}
+
+}
+
+int main(int argc, char** argv) {
+	int numThreads = 0;
+	uint32_t pcmRate = 0;
+	const char* outputDirectory = nullptr;
+	std::vector<const char*> arguments;
+	for (int i = 1; i < argc; i++) {
+		if (std::strcmp(argv[i], "--threads") == 0 && i + 1 < argc) {
+			numThreads = std::atoi(argv[++i]);
+		}
+		else if (std::strcmp(argv[i], "--pcm-rate") == 0 && i + 1 < argc) {
+			pcmRate = std::strtoul(argv[++i], nullptr, 10);
+		}
+		else if (std::strcmp(argv[i], "-o") == 0 && i + 1 < argc) {
+			outputDirectory = argv[++i];
+		}
+		else if (argv[i][0] != '-') {
+			arguments.push_back(argv[i]);
+		}
+		else {
+			std::fprintf(stderr, "unknown argument: %s\n", argv[i]);
+			return 1;
+		}
+	}
+	if (arguments.empty()) {
+		std::fprintf(stderr, "usage: %s [--threads n] [--pcm-rate hz] [-o output directory] <file or directory>...\n", argv[0]);
+		return 1;
+	}
+
+	std::vector<Input> inputs;
+	for (const char* argument : arguments) {
+		if (!collectInputs(argument, outputDirectory, inputs)) {
+			std::fprintf(stderr, "could not read %s\n", argument);
+			return 1;
+		}
+	}
+
+	const auto start = std::chrono::steady_clock::now();
+	std::atomic<uint64_t> totalFrames{ 0 };
+	std::atomic<int> failures{ 0 };
+	ThreadPool pool(numThreads);
+	for (const Input& input : inputs) {
+		pool.submit([&] {
+			SessionReader reader;
+			if (!reader.open(input.path.c_str(), pcmRate)) {
+				std::fprintf(stderr, "could not read %s\n", input.path.c_str());
+				failures += 1;
+				return;
+			}
+			std::vector<featurelog::Frame> frames;
+			featurelog::Frame frame;
+			while (reader.next(frame)) {
+				frames.push_back(frame);
+			}
+			totalFrames += frames.size();
+			if (!input.output.empty()) {
+				std::error_code error;
+				fs::create_directories(input.output.parent_path(), error);
+				if (!sessionfile::write(input.output.c_str(), frames)) {
+					std::fprintf(stderr, "could not write %s\n", input.output.c_str());
+					failures += 1;
+				}
+			}
+		});
+	}
+	pool.wait();
+	const double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+	const double audioSeconds = double(totalFrames) * windowStride / sampleRate;
+	std::printf("%zu files, %d failed, %.1f s of audio in %.3f s on %d threads: %.0f files/s, %.0fx real time\n",
+		inputs.size(), failures.load(), audioSeconds, seconds, pool.size(),
+		inputs.size() / seconds, audioSeconds / seconds);
+	return failures > 0 ? 1 : 0;
+}
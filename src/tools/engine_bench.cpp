@@ -0,0 +1,120 @@
+// Measures the throughput of the multi-stream engine in host/engine.hpp.
+//
+// Every stream gets the same synthetic signal with a word-like burst every
+// second, shifted in time per stream. Audio arrives in ticks like packets
+// from many devices: each tick pushes tick milliseconds to every stream and
+// processes them. Reports real-time streams per core from the CPU time and
+// per machine from the wall time.
+//
+// Usage: engine_bench [--streams n] [--threads n] [--seconds s] [--tick ms] [--templates templates.bin]
+
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <ctime>
+#include <random>
+#include <vector>
+
+#include <app/parameters.hpp>
+#include <host/engine.hpp>
+#include <host/template_file.hpp>
+
+namespace {
+
+// Quiet noise with a 400 ms two-tone burst every second
+std::vector<int16_t> syntheticAudio(int seconds) {
+	std::mt19937 random(1);
+	std::normal_distribution<float> noise(0, 30);
+	std::vector<int16_t> samples(seconds * sampleRate);
+	for (size_t i = 0; i < samples.size(); i++) {
+		const float t = float(i) / sampleRate;
+		const bool burst = std::fmod(t, 1.0f) > 0.3f && std::fmod(t, 1.0f) < 0.7f;
+		const float tone = burst ? 6000 * (std::sin(2 * M_PI * 440 * t) + 0.5f * std::sin(2 * M_PI * 1320 * t)) : 0;
+		samples[i] = static_cast<int16_t>(tone + noise(random));
+	}
+	return samples;
+}
+
+double cpuSeconds() {
+	timespec time;
+	clock_gettime(CLOCK_PROCESS_CPUTIME_ID, &time);
+	return time.tv_sec + time.tv_nsec * 1e-9;
+}
+
+}
+
+int main(int argc, char** argv) {
+	int numStreams = 256;
+	int numThreads = 0;
+	int seconds = 10;
+	int tickMilliseconds = 20;
+	const char* templatesPath = nullptr;
+	for (int i = 1; i < argc; i++) {
+		if (std::strcmp(argv[i], "--streams") == 0 && i + 1 < argc) {
+			numStreams = std::max(1, std::atoi(argv[++i]));
+		}
+		else if (std::strcmp(argv[i], "--threads") == 0 && i + 1 < argc) {
+			numThreads = std::atoi(argv[++i]);
+		}
+		else if (std::strcmp(argv[i], "--seconds") == 0 && i + 1 < argc) {
+			seconds = std::max(1, std::atoi(argv[++i]));
+		}
+		else if (std::strcmp(argv[i], "--tick") == 0 && i + 1 < argc) {
+			tickMilliseconds = std::max(1, std::atoi(argv[++i]));
+		}
+		else if (std::strcmp(argv[i], "--templates") == 0 && i + 1 < argc) {
+			templatesPath = argv[++i];
+		}
+		else {
+			std::fprintf(stderr, "usage: %s [--streams n] [--threads n] [--seconds s] [--tick ms] [--templates templates.bin]\n", argv[0]);
+			return 1;
+		}
+	}
+
+	MappedTemplateFile templates;
+	if (templatesPath != nullptr) {
+		templatedb::Error error;
+		if (!templates.open(templatesPath, error) || error != templatedb::Error::None
+				|| templates.database().check(featureVectorDim, maxTemplates, maxTemplateFrames) != templatedb::Error::None) {
+			std::fprintf(stderr, "could not use %s\n", templatesPath);
+			return 1;
+		}
+	}
+
+	Engine engine(templates.database(), numThreads);
+	for (int s = 0; s < numStreams; s++) {
+		engine.addStream();
+	}
+
+	const std::vector<int16_t> audio = syntheticAudio(seconds + 1);
+	const size_t tickSamples = size_t(tickMilliseconds) * sampleRate / 1000;
+	const size_t numSamples = size_t(seconds) * sampleRate;
+	std::vector<Engine::Event> events;
+	size_t numEvents = 0;
+
+	const double cpuStart = cpuSeconds();
+	const auto wallStart = std::chrono::steady_clock::now();
+	for (size_t offset = 0; offset < numSamples; offset += tickSamples) {
+		const size_t count = std::min(tickSamples, numSamples - offset);
+		for (int s = 0; s < numStreams; s++) {
+			// Streams are shifted by up to one second so words do not all end in the same tick
+			const size_t shift = (size_t(s) * 7919) % sampleRate;
+			engine.push(s, audio.data() + shift + offset, count);
+		}
+		engine.process();
+		engine.takeEvents(events);
+		numEvents += events.size();
+		events.clear();
+	}
+	const double cpu = cpuSeconds() - cpuStart;
+	const double wall = std::chrono::duration<double>(std::chrono::steady_clock::now() - wallStart).count();
+
+	const double streamSeconds = double(numStreams) * numSamples / sampleRate;
+	std::printf("%d streams of %d s on %d threads, %d ms ticks, %zu words\n",
+		numStreams, seconds, engine.numThreads(), tickMilliseconds, numEvents);
+	std::printf("cpu %.2f s, wall %.2f s: %.0f real-time streams per core, %.0f on this machine\n",
+		cpu, wall, streamSeconds / cpu, streamSeconds / wall);
+	return 0;
+}
@@ -0,0 +1,122 @@
+// Runs the firmware's enrollment log on a flash image file.
+//
+// Usage: enroll_tool <flash image> list
+//        enroll_tool <flash image> add <word> <session.txt> [n]   enroll the n-th word spoken in a session
+//        enroll_tool <flash image> forget <word>
+//        enroll_tool <flash image> stress <rounds>                 enroll and forget repeatedly, report wear
+
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <vector>
+
+#include <app/parameters.hpp>
+#include <app/feature_vector.hpp>
+#include <app/enrollment.hpp>
+#include <host/flash_file.hpp>
+#include <host/segmentation.hpp>
+
+namespace {
+
+// The two 16 kB banks of the ENROLLMENT region in scripts/linkerscript.ld
+constexpr uint32_t bankSize = 16 * 1024;
+
+using EnrollmentLog = enrollment::Log<FlashFile::Region, featureVectorDim, maxEnrolledTemplates>;
+
+// Segments a session like the firmware and returns the feature vectors of the n-th word
+bool extractWord(const char* path, int wordIdx, std::vector<FeatureVector>& word) {
+	std::vector<segmentation::Word> words;
+	if (!segmentation::segmentSession(path, words) || wordIdx < 0 || wordIdx >= int(words.size())) return false;
+	word = words[wordIdx];
+	return true;
+}
+
+void list(const EnrollmentLog& log) {
+	std::printf("%d templates, %u bytes free, generation %u\n",
+		log.size(), static_cast<unsigned>(log.bytesFree()), static_cast<unsigned>(log.generation()));
+	for (int i = 0; i < log.size(); i++) {
+		std::printf("%-16s %3d frames\n", log.text(i), log.numFrames(i));
+	}
+}
+
+}
+
+int main(int argc, char** argv) {
+	if (argc < 3) {
+		std::fprintf(stderr, "usage: %s <flash image> list|add|forget|stress ...\n", argv[0]);
+		return 1;
+	}
+
+	FlashFile flash;
+	if (!flash.open(argv[1], 2 * bankSize)) {
+		std::fprintf(stderr, "could not open %s\n", argv[1]);
+		return 1;
+	}
+	FlashFile::Region bankA(flash, 0, bankSize);
+	FlashFile::Region bankB(flash, bankSize, bankSize);
+	EnrollmentLog log(bankA, bankB);
+	if (!log.mount()) {
+		std::fprintf(stderr, "could not mount the enrollment log\n");
+		return 1;
+	}
+
+	const char* command = argv[2];
+	if (std::strcmp(command, "list") == 0) {
+		list(log);
+	}
+	else if (std::strcmp(command, "add") == 0 && (argc == 5 || argc == 6)) {
+		std::vector<FeatureVector> word;
+		int wordIdx = (argc == 6) ? std::atoi(argv[5]) : 0;
+		if (!extractWord(argv[4], wordIdx, word)) {
+			std::fprintf(stderr, "no word %d in %s\n", wordIdx, argv[4]);
+			return 1;
+		}
+		enrollment::Error error = log.append(argv[3], word.data(), word.size());
+		if (error != enrollment::Error::None) {
+			std::fprintf(stderr, "could not enroll: %s\n", enrollment::errorName(error));
+			return 1;
+		}
+		list(log);
+	}
+	else if (std::strcmp(command, "forget") == 0 && argc == 4) {
+		const int removed = log.forget(argv[3]);
+		if (removed < 0) {
+			std::fprintf(stderr, "could not forget: %s\n", enrollment::errorName(enrollment::Error::FlashError));
+			return 1;
+		}
+		std::printf("forgot %d templates\n", removed);
+		list(log);
+	}
+	else if (std::strcmp(command, "stress") == 0 && argc == 4) {
+		// Keeps a few templates live while enrolling and forgetting others
+		const int rounds = std::atoi(argv[3]);
+		std::vector<FeatureVector> word(30);
+		for (int i = 0; i < rounds; i++) {
+			word[0][0] = i;
+			char text[enrollment::maxTextLength + 1];
+			std::snprintf(text, sizeof(text), "word%d", i % 8);
+			if (log.forget(text) < 0) {
+				std::fprintf(stderr, "round %d: could not forget: %s\n", i, enrollment::errorName(enrollment::Error::FlashError));
+				return 1;
+			}
+			enrollment::Error error = log.append(text, word.data(), word.size());
+			if (error != enrollment::Error::None) {
+				std::fprintf(stderr, "round %d: %s\n", i, enrollment::errorName(error));
+				return 1;
+			}
+		}
+		// Remounting must find the same templates
+		EnrollmentLog remounted(bankA, bankB);
+		if (!remounted.mount() || remounted.size() != log.size()) {
+			std::fprintf(stderr, "remount found %d templates instead of %d\n", remounted.size(), log.size());
+			return 1;
+		}
+		list(remounted);
+		std::printf("%u sector erases for %d appends\n", static_cast<unsigned>(flash.eraseCount()), rounds);
+	}
+	else {
+		std::fprintf(stderr, "unknown command: %s\n", command);
+		return 1;
+	}
+	return 0;
+}
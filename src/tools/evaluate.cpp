@@ -0,0 +1,293 @@
+// Measures recognition accuracy on recorded sessions.
+//
+// Sessions are named <speaker>_<language>.txt like in data/. Every session is
+// segmented like on the device and its words are labelled with the lines of
+// the word list. Each word is then recognized with the firmware's DTW and
+// distance metric against the templates of a run:
+//
+//  * leave one speaker out: the templates are all words of the other
+//    speakers, the test words are those of the held out speaker
+//  * session pairs: the templates are the words of one session, the test
+//    words those of another, grouped into same or cross speaker and language
+//
+// Utterances are recognized in parallel. Prints every utterance with its best
+// match, the DTW cost of that match and the cost of the best template with the
+// correct label, then the accuracy per run and group and a confusion matrix.
+//
+// Usage: evaluate [--words words.txt] [--threads n] [--quiet] <session>...
+
+#include <algorithm>
+#include <array>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <limits>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include <app/parameters.hpp>
+#include <app/feature_vector.hpp>
+#include <app/recognizer.hpp>
+#include <host/segmentation.hpp>
+#include <host/thread_pool.hpp>
+
+namespace {
+
+// Enough for the words of all recorded sessions
+constexpr int maxEvaluationTemplates = 256;
+using EvaluationVocabulary = Vocabulary<FeatureVector, maxEvaluationTemplates>;
+
+struct Session {
+	const char* path;
+	std::string speaker;
+	std::string language;
+	std::vector<segmentation::Word> words;
+};
+
+enum class Group : uint8_t {
+	LeaveOneOut,
+	SameSpeakerSameLanguage,
+	SameSpeakerCrossLanguage,
+	CrossSpeakerSameLanguage,
+	CrossSpeakerCrossLanguage,
+};
+
+constexpr int numGroups = 5;
+constexpr const char* groupNames[] = {
+	"leave one speaker out",
+	"same speaker, same language",
+	"same speaker, cross language",
+	"cross speaker, same language",
+	"cross speaker, cross language",
+};
+
+struct Run {
+	std::string name;
+	Group group;
+	// Indices into the sessions
+	std::vector<int> templateSessions;
+	std::vector<int> testSessions;
+};
+
+struct Utterance {
+	int run;
+	int session;
+	int index;
+	int best = -1;
+	uint32_t cost = std::numeric_limits<uint32_t>::max();
+	// Cheapest template with the correct label
+	uint32_t trueCost = std::numeric_limits<uint32_t>::max();
+};
+
+// "data/amar_en.txt" is speaker "amar", language "en"
+bool parseSessionName(const char* path, std::string& speaker, std::string& language) {
+	const char* slash = std::strrchr(path, '/');
+	std::string name = (slash != nullptr) ? slash + 1 : path;
+	name = name.substr(0, name.find('.'));
+	size_t separator = name.rfind('_');
+	if (separator == std::string::npos || separator == 0 || separator + 1 == name.size()) return false;
+	speaker = name.substr(0, separator);
+	language = name.substr(separator + 1);
+	return true;
+}
+
+std::vector<Run> makeRuns(const std::vector<Session>& sessions) {
+	std::vector<Run> runs;
+
+	std::vector<std::string> speakers;
+	for (const Session& session : sessions) {
+		if (std::find(speakers.begin(), speakers.end(), session.speaker) == speakers.end()) {
+			speakers.push_back(session.speaker);
+		}
+	}
+	if (speakers.size() > 1) {
+		for (const std::string& speaker : speakers) {
+			Run run{ "without " + speaker, Group::LeaveOneOut, {}, {} };
+			for (size_t i = 0; i < sessions.size(); i++) {
+				(sessions[i].speaker == speaker ? run.testSessions : run.templateSessions).push_back(i);
+			}
+			runs.push_back(run);
+		}
+	}
+
+	for (size_t t = 0; t < sessions.size(); t++) {
+		for (size_t s = 0; s < sessions.size(); s++) {
+			if (s == t) continue;
+			bool sameSpeaker = sessions[t].speaker == sessions[s].speaker;
+			bool sameLanguage = sessions[t].language == sessions[s].language;
+			Group group = sameSpeaker
+				? (sameLanguage ? Group::SameSpeakerSameLanguage : Group::SameSpeakerCrossLanguage)
+				: (sameLanguage ? Group::CrossSpeakerSameLanguage : Group::CrossSpeakerCrossLanguage);
+			std::string name = sessions[t].speaker + "_" + sessions[t].language + " -> " + sessions[s].speaker + "_" + sessions[s].language;
+			runs.push_back(Run{ name, group, { int(t) }, { int(s) } });
+		}
+	}
+	return runs;
+}
+
+struct Accuracy {
+	int correct = 0;
+	int total = 0;
+
+	void add(bool isCorrect) {
+		correct += isCorrect;
+		total += 1;
+	}
+
+	void print(const char* label) const {
+		std::printf("%-40s %4d / %4d  %6.1f%%\n", label, correct, total, total > 0 ? 100.0 * correct / total : 0.0);
+	}
+};
+
+}
+
+int main(int argc, char** argv) {
+	const char* wordListPath = "data/words.txt";
+	int numThreads = 0;
+	bool quiet = false;
+	std::vector<const char*> paths;
+	for (int i = 1; i < argc; i++) {
+		if (std::strcmp(argv[i], "--words") == 0 && i + 1 < argc) {
+			wordListPath = argv[++i];
+		}
+		else if (std::strcmp(argv[i], "--threads") == 0 && i + 1 < argc) {
+			numThreads = std::atoi(argv[++i]);
+		}
+		else if (std::strcmp(argv[i], "--quiet") == 0) {
+			quiet = true;
+		}
+		else if (argv[i][0] != '-') {
+			paths.push_back(argv[i]);
+		}
+		else {
+			std::fprintf(stderr, "unknown argument: %s\n", argv[i]);
+			return 1;
+		}
+	}
+	if (paths.size() < 2) {
+		std::fprintf(stderr, "usage: %s [--words words.txt] [--threads n] [--quiet] <speaker_language.txt>...\n", argv[0]);
+		return 1;
+	}
+
+	std::vector<std::string> wordList;
+	if (!segmentation::readWordList(wordListPath, wordList)) {
+		std::fprintf(stderr, "could not read %s\n", wordListPath);
+		return 1;
+	}
+	const int numLabels = wordList.size();
+
+	std::vector<Session> sessions(paths.size());
+	for (size_t i = 0; i < paths.size(); i++) {
+		sessions[i].path = paths[i];
+		if (!parseSessionName(paths[i], sessions[i].speaker, sessions[i].language)) {
+			std::fprintf(stderr, "%s is not named <speaker>_<language>\n", paths[i]);
+			return 1;
+		}
+	}
+
+	ThreadPool pool(numThreads);
+	std::vector<char> ok(sessions.size());
+	for (size_t i = 0; i < sessions.size(); i++) {
+		pool.submit([&, i] { ok[i] = segmentation::segmentSession(sessions[i].path, sessions[i].words); });
+	}
+	pool.wait();
+	for (size_t i = 0; i < sessions.size(); i++) {
+		if (!ok[i]) {
+			std::fprintf(stderr, "could not read %s\n", sessions[i].path);
+			return 1;
+		}
+		if (int(sessions[i].words.size()) != numLabels) {
+			std::fprintf(stderr, "warning: %s has %zu words, the word list %d\n", sessions[i].path, sessions[i].words.size(), numLabels);
+		}
+		// Words beyond the word list have no label
+		sessions[i].words.resize(std::min<size_t>(sessions[i].words.size(), numLabels));
+	}
+
+	// The vocabulary of every run and the label of each of its entries
+	std::vector<Run> runs = makeRuns(sessions);
+	std::vector<EvaluationVocabulary> vocabularies(runs.size());
+	std::vector<std::vector<int>> vocabularyLabels(runs.size());
+	std::vector<Utterance> utterances;
+	for (size_t r = 0; r < runs.size(); r++) {
+		for (int s : runs[r].templateSessions) {
+			for (size_t w = 0; w < sessions[s].words.size(); w++) {
+				const segmentation::Word& word = sessions[s].words[w];
+				if (!vocabularies[r].add(wordList[w].c_str(), word.data(), word.size())) {
+					std::fprintf(stderr, "more than %d templates in run %s\n", maxEvaluationTemplates, runs[r].name.c_str());
+					return 1;
+				}
+				vocabularyLabels[r].push_back(w);
+			}
+		}
+		for (int s : runs[r].testSessions) {
+			for (size_t w = 0; w < sessions[s].words.size(); w++) {
+				utterances.push_back(Utterance{ int(r), s, int(w) });
+			}
+		}
+	}
+
+	for (Utterance& utterance : utterances) {
+		pool.submit([&] {
+			// Too large for the stack of every worker, one per thread like the firmware's single one
+			thread_local std::unique_ptr<Dtw<maxWords, FeatureVector>> dtwWorkspace(new Dtw<maxWords, FeatureVector>);
+			thread_local std::array<uint32_t, maxEvaluationTemplates> costs;
+			const EvaluationVocabulary& vocabulary = vocabularies[utterance.run];
+			const std::vector<int>& labels = vocabularyLabels[utterance.run];
+			const segmentation::Word& word = sessions[utterance.session].words[utterance.index];
+
+			int bestIdx = findBestMatch(vocabulary, word.data(), word.size(), *dtwWorkspace, costs.data());
+			if (bestIdx < 0) return;
+			utterance.best = labels[bestIdx];
+			utterance.cost = costs[bestIdx];
+			for (int i = 0; i < vocabulary.size(); i++) {
+				if (labels[i] == utterance.index) {
+					utterance.trueCost = std::min(utterance.trueCost, costs[i]);
+				}
+			}
+		});
+	}
+	pool.wait();
+
+	std::vector<Accuracy> runAccuracy(runs.size());
+	std::array<Accuracy, numGroups> groupAccuracy;
+	std::vector<std::vector<int>> confusion(numLabels, std::vector<int>(numLabels + 1));
+	for (const Utterance& utterance : utterances) {
+		const bool correct = utterance.best == utterance.index;
+		runAccuracy[utterance.run].add(correct);
+		groupAccuracy[static_cast<int>(runs[utterance.run].group)].add(correct);
+		confusion[utterance.index][utterance.best >= 0 ? utterance.best : numLabels] += 1;
+		if (!quiet) {
+			std::printf("%-24s %-20s %2d %-10s -> %-10s cost %8lu true %8lu %s\n",
+				runs[utterance.run].name.c_str(), sessions[utterance.session].path, utterance.index,
+				wordList[utterance.index].c_str(), utterance.best >= 0 ? wordList[utterance.best].c_str() : "-",
+				static_cast<unsigned long>(utterance.cost), static_cast<unsigned long>(utterance.trueCost),
+				correct ? "ok" : "MISS");
+		}
+	}
+
+	std::printf("\naccuracy per run:\n");
+	for (size_t r = 0; r < runs.size(); r++) {
+		runAccuracy[r].print(runs[r].name.c_str());
+	}
+	std::printf("\naccuracy per group:\n");
+	for (int g = 0; g < numGroups; g++) {
+		if (groupAccuracy[g].total > 0) {
+			groupAccuracy[g].print(groupNames[g]);
+		}
+	}
+
+	std::printf("\nconfusion over all runs (rows: spoken, columns: recognized):\n%-10s", "");
+	for (const std::string& word : wordList) {
+		std::printf(" %8.8s", word.c_str());
+	}
+	std::printf(" %8s\n", "none");
+	for (int label = 0; label < numLabels; label++) {
+		std::printf("%-10.10s", wordList[label].c_str());
+		for (int count : confusion[label]) {
+			std::printf(" %8d", count);
+		}
+		std::printf("\n");
+	}
+	return 0;
+}
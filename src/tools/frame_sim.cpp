@@ -0,0 +1,338 @@
+// Simulates the firmware's frame timing on the host.
+//
+// Replays a recorded session (data/*.txt) through the firmware's word
+// segmentation and charges every frame with stage costs measured on the
+// target, taken from a captured 'prof' telemetry dump. Blocks arrive every
+// windowStride samples like from the ADC and are preprocessed by the feature
+// interrupt, a block that is replaced before it is free again is lost. The
+// interrupt queues every frame for thread mode, which does the DTW and the
+// telemetry whenever the interrupt is idle; frames that do not fit the queue
+// are dropped. The result is the same deadline accounting the firmware prints
+// in its stat: line, for any vocabulary size. Thread mode sleeps when it runs
+// out of work, the share of time awake is the firmware's duty: figure.
+//
+// The profiler zones are mapped to the stage costs by zoneCosts. The mel-ref
+// zone of MEL_REFERENCE builds is left out on purpose: it times the unfused
+// filterbank for comparison only, beside the mel zone, and is not part of a
+// frame's cost in a normal build.
+//
+// Blocks are tagged with their sample index like on the target, so the
+// speech-end-to-decision latency of every recognized word is exact. Several
+// sessions can be given to get the latency distribution over a whole corpus.
+//
+// Usage: frame_sim <prof dump> <session.txt>... [--templates n] [--telemetry cycles] [--no-mfcc] [--worst-case]
+
+#include <algorithm>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <deque>
+#include <vector>
+
+#include <app/parameters.hpp>
+#include <app/word_segmenter.hpp>
+#include <app/frame_budget.hpp>
+#include <app/latency.hpp>
+#include <app/duty_cycle.hpp>
+#include <host/session_reader.hpp>
+
+namespace {
+
+constexpr uint32_t targetFrequency = 84'000'000;
+constexpr uint32_t frameBudgetCycles = uint64_t(windowStride) * targetFrequency / sampleRate;
+
+// The feature interrupt's budget stages, and the DTW of thread mode
+enum class Cost : uint8_t {
+	Preprocess,
+	Features,
+	DtwPerTemplate,
+};
+
+struct ZoneCost {
+	const char* zone;
+	Cost cost;
+};
+
+// Which profiler zones make up which cost
+constexpr ZoneCost zoneCosts[] = {
+	{ "copy", Cost::Preprocess },
+	{ "avg", Cost::Preprocess },
+	{ "normal", Cost::Preprocess },
+	{ "decim", Cost::Preprocess },
+	{ "fft", Cost::Features },
+	{ "mel", Cost::Features },
+	{ "dct", Cost::Features },
+	{ "fvscl", Cost::Features },
+	{ "dtw", Cost::DtwPerTemplate },
+};
+
+struct StageCosts {
+	uint32_t preprocess = 0;
+	uint32_t features = 0;
+	uint32_t dtwPerTemplate = 0;
+	uint32_t telemetry = 0;
+};
+
+// Parses "prof:<name> n:<count> min:<cycles> max:<cycles> mean:<cycles> ..." lines
+bool readProfile(const char* path, bool worstCase, StageCosts& costs) {
+	FILE* file = std::fopen(path, "r");
+	if (file == nullptr) return false;
+
+	char line[512];
+	char name[64];
+	unsigned long count, min, max, mean;
+	while (std::fgets(line, sizeof(line), file) != nullptr) {
+		if (std::sscanf(line, "prof:%63s n:%lu min:%lu max:%lu mean:%lu", name, &count, &min, &max, &mean) != 5) continue;
+		uint32_t cycles = worstCase ? max : mean;
+		for (const ZoneCost& zoneCost : zoneCosts) {
+			if (std::strcmp(zoneCost.zone, name) != 0) continue;
+			switch (zoneCost.cost) {
+				case Cost::Preprocess: costs.preprocess += cycles; break;
+				case Cost::Features: costs.features += cycles; break;
+				case Cost::DtwPerTemplate: costs.dtwPerTemplate += cycles; break;
+			}
+		}
+	}
+	std::fclose(file);
+	return true;
+}
+
+void printCycles(const char* label, int64_t cycles) {
+	std::printf("%s%.2f ms", label, cycles * 1000.0 / targetFrequency);
+}
+
+void printSamples(const char* label, uint32_t samples) {
+	std::printf("%s%.2f ms", label, latency::samplesToMicroseconds(samples, sampleRate) / 1000.0);
+}
+
+// Enough for the decisions of all recorded sessions
+using LatencyTracker = latency::Tracker<4096>;
+
+struct Options {
+	int numTemplates = 8;
+	bool mfccTelemetry = true;
+};
+
+// Thread mode work queued by one frame
+struct ThreadJob {
+	uint64_t remainingCycles;
+	int64_t block;
+	bool wordFinished;
+	int wordLength;
+	latency::SampleIndex speechEnd;
+};
+
+// The firmware's wait primitive on the simulated clock, every sleep lasts until wakeTime
+struct SimulatedSleep {
+	uint64_t time = 0;
+	uint64_t wakeTime = 0;
+
+	void lock() {}
+	void unlock() {}
+	void wait() {
+		time = std::max(time, wakeTime);
+	}
+	uint32_t now() {
+		return uint32_t(time);
+	}
+};
+
+// Accumulated over all sessions
+struct Results {
+	budget::FrameBudget frameBudget{ frameBudgetCycles };
+	LatencyTracker decisionLatency;
+	uint32_t framesDropped = 0;
+	uint64_t activeCycles = 0;
+	uint64_t sleepCycles = 0;
+};
+
+// Replays one session on a fresh timeline starting at sample index 0
+void simulate(const std::vector<featurelog::Frame>& frames, const StageCosts& costs, const Options& options, Results& results) {
+	budget::FrameBudget& frameBudget = results.frameBudget;
+	WordSegmenter<maxWords> wordSegmenter;
+	latency::SampleIndex lastLoudFrameEnd = 0;
+
+	// Thread mode has run up to clock.time, its front job may be half done.
+	// Sessions are short enough for the meter's 32 bit ticks.
+	SimulatedSleep clock;
+	duty::Meter<SimulatedSleep> dutyMeter(clock);
+	uint64_t& threadTime = clock.time;
+	std::deque<ThreadJob> jobs;
+	bool jobStarted = false;
+	auto runThread = [&](uint64_t until) {
+		while (!jobs.empty() && threadTime < until) {
+			ThreadJob& job = jobs.front();
+			jobStarted = true;
+			const uint64_t cycles = std::min(job.remainingCycles, until - threadTime);
+			threadTime += cycles;
+			job.remainingCycles -= cycles;
+			if (job.remainingCycles > 0) break;
+			if (job.wordFinished) {
+				// The sample clock at the time the result is printed
+				latency::SampleIndex decision = threadTime * sampleRate / targetFrequency;
+				results.decisionLatency.add(decision - job.speechEnd);
+				std::printf("word at frame %lld, %d frames: ", static_cast<long long>(job.block), job.wordLength);
+				printSamples("latency ", decision - job.speechEnd);
+				std::printf("\n");
+			}
+			jobs.pop_front();
+			jobStarted = false;
+		}
+		if (jobs.empty() && threadTime < until) {
+			clock.wakeTime = until;
+			dutyMeter.idle([] { return false; });
+		}
+	};
+
+	// Block n is complete at (n + 1) * frameBudgetCycles. The feature interrupt
+	// picks up the newest complete block whenever it is free, older ones are
+	// lost, and preempts thread mode while it runs.
+	uint64_t interruptFree = 0;
+	int64_t lastProcessed = -1;
+	const int64_t numBlocks = frames.size();
+	while (true) {
+		int64_t block = std::max<int64_t>(int64_t(interruptFree / frameBudgetCycles) - 1, lastProcessed + 1);
+		if (block >= numBlocks) break;
+
+		uint64_t readyTime = uint64_t(block + 1) * frameBudgetCycles;
+		uint64_t now = std::max(interruptFree, readyTime);
+		runThread(now);
+		latency::SampleIndex sampleIndex = block * windowStride;
+		frameBudget.addLostBlocks(block - lastProcessed - 1);
+		frameBudget.beginFrame(readyTime, now);
+
+		auto segment = wordSegmenter.update(frames[block].rmsAmplitude);
+		if (segment.loud) {
+			lastLoudFrameEnd = sampleIndex + windowStride;
+		}
+
+		now += costs.preprocess;
+		frameBudget.endStage(budget::Stage::Preprocess, now);
+
+		if (segment.storeFeatureVector || options.mfccTelemetry) {
+			now += costs.features;
+		}
+		frameBudget.endStage(budget::Stage::Features, now);
+		frameBudget.endFrame(now);
+
+		// The job thread mode is working on has left the queue
+		const size_t queued = jobs.size() - (jobStarted ? 1 : 0);
+		if (queued < size_t(featureQueueSize)) {
+			uint64_t cycles = costs.telemetry;
+			if (segment.wordFinished) {
+				cycles += uint64_t(costs.dtwPerTemplate) * options.numTemplates;
+			}
+			jobs.push_back(ThreadJob{ cycles, block, segment.wordFinished, segment.wordLength, lastLoudFrameEnd });
+		}
+		else {
+			results.framesDropped += 1;
+		}
+
+		threadTime = now;
+		interruptFree = now;
+		lastProcessed = block;
+	}
+	while (!jobs.empty()) {
+		runThread(threadTime + frameBudgetCycles);
+	}
+	const duty::Counters duty = dutyMeter.takePeriod();
+	results.activeCycles += duty.activeTicks;
+	results.sleepCycles += duty.sleepTicks;
+}
+
+}
+
+int main(int argc, char** argv) {
+	if (argc < 3) {
+		std::fprintf(stderr, "usage: %s <prof dump> <session.txt>... [--templates n] [--telemetry cycles] [--no-mfcc] [--worst-case]\n", argv[0]);
+		return 1;
+	}
+
+	Options options;
+	bool worstCase = false;
+	uint32_t telemetryCycles = 0;
+	std::vector<const char*> sessions;
+	for (int i = 2; i < argc; i++) {
+		if (std::strcmp(argv[i], "--templates") == 0 && i + 1 < argc) {
+			options.numTemplates = std::atoi(argv[++i]);
+		}
+		else if (std::strcmp(argv[i], "--telemetry") == 0 && i + 1 < argc) {
+			telemetryCycles = std::strtoul(argv[++i], nullptr, 10);
+		}
+		else if (std::strcmp(argv[i], "--no-mfcc") == 0) {
+			options.mfccTelemetry = false;
+		}
+		else if (std::strcmp(argv[i], "--worst-case") == 0) {
+			worstCase = true;
+		}
+		else if (std::strncmp(argv[i], "--", 2) != 0) {
+			sessions.push_back(argv[i]);
+		}
+		else {
+			std::fprintf(stderr, "unknown argument: %s\n", argv[i]);
+			return 1;
+		}
+	}
+	if (sessions.empty()) {
+		std::fprintf(stderr, "no session given\n");
+		return 1;
+	}
+
+	StageCosts costs;
+	costs.telemetry = telemetryCycles;
+	if (!readProfile(argv[1], worstCase, costs)) {
+		std::fprintf(stderr, "could not read %s\n", argv[1]);
+		return 1;
+	}
+
+	std::printf("budget per frame: ");
+	printCycles("", frameBudgetCycles);
+	printCycles(", pre: ", costs.preprocess);
+	printCycles(", feat: ", costs.features);
+	printCycles(", dtw: ", int64_t(costs.dtwPerTemplate) * options.numTemplates);
+	std::printf(" (%d templates)\n", options.numTemplates);
+
+	Results results;
+	for (const char* session : sessions) {
+		std::vector<featurelog::Frame> frames;
+		SessionReader reader;
+		if (!reader.open(session)) {
+			std::fprintf(stderr, "could not read %s\n", session);
+			return 1;
+		}
+		featurelog::Frame frame;
+		while (reader.next(frame)) {
+			frames.push_back(frame);
+		}
+		std::printf("%s:\n", session);
+		simulate(frames, costs, options, results);
+	}
+
+	const budget::Counters& total = results.frameBudget.total();
+	std::printf("frames: %lu, deadline misses: %lu, lost blocks: %lu, dropped frames: %lu, ",
+		static_cast<unsigned long>(total.frames), static_cast<unsigned long>(total.deadlineMisses),
+		static_cast<unsigned long>(total.lostBlocks), static_cast<unsigned long>(results.framesDropped));
+	printCycles("worst slack: ", total.frames > 0 ? total.worstSlack : 0);
+	std::printf("\n");
+	for (int i = 0; i < budget::numStages; i++) {
+		if (total.overruns[i] > 0) {
+			std::printf("overruns in %s: %lu\n", budget::stageNames[i], static_cast<unsigned long>(total.overruns[i]));
+		}
+	}
+	const uint64_t totalCycles = results.activeCycles + results.sleepCycles;
+	if (totalCycles > 0) {
+		std::printf("duty cycle: %.1f%% active, ", 100.0 * results.activeCycles / totalCycles);
+		printCycles("", results.activeCycles);
+		printCycles(" active, ", results.sleepCycles);
+		std::printf(" asleep\n");
+	}
+	if (results.decisionLatency.size() > 0) {
+		std::printf("decisions: %d, latency", results.decisionLatency.size());
+		printSamples(" p50: ", results.decisionLatency.percentile(50));
+		printSamples(", p90: ", results.decisionLatency.percentile(90));
+		printSamples(", p99: ", results.decisionLatency.percentile(99));
+		printSamples(", max: ", results.decisionLatency.percentile(100));
+		std::printf("\n");
+	}
+	return 0;
+}
@@ -0,0 +1,235 @@
+// Compares two front end configurations, by default the decimated one
+// (-DDECIMATE=ON on the firmware) with the full rate one. To try another
+// configuration, point CandidateConfig at its settings (see
+// app/pipeline_config.hpp).
+//
+// Runs every audio file through both configurations side by side, each with
+// the firmware's segmentation and, with --templates, its DTW, and reports:
+//
+//  * the distance of the candidate's feature vectors from the reference's
+//    within words, relative to the mean distance between consecutive frames
+//  * the mean difference of the amplitude the segmentation uses, relative to
+//    the mean amplitude
+//  * the words of each configuration, their best match and how many agree;
+//    if a file is named <word>.wav or <word>_<anything>.wav, its words count
+//    as correct when they match a template of that text
+//  * the time per block of each front end, features computed for every block
+//
+// Usage: frontend_compare [--templates templates.bin] [--pcm-rate hz] <audio file>...
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include <app/parameters.hpp>
+#include <app/recognizer.hpp>
+#include <app/vocabulary.hpp>
+#include <host/audio_file.hpp>
+#include <host/resampler.hpp>
+#include <host/template_file.hpp>
+
+namespace {
+
+using ReferenceConfig = PipelineConfig<DefaultPipelineSettings>;
+using CandidateConfig = PipelineConfig<DecimatedPipelineSettings>;
+// Both feed the same templates and segmentation
+static_assert(CandidateConfig::sampleRate == sampleRate && CandidateConfig::windowStride == windowStride);
+static_assert(CandidateConfig::featureVectorDim == featureVectorDim);
+
+using CompareVocabulary = Vocabulary<FeatureVector, maxTemplates>;
+
+struct Word {
+	int commandIdx;
+	uint32_t cost;
+	latency::SampleIndex start;
+};
+
+// One front end configuration with its own segmentation and word recognizer
+template<typename Config>
+struct Configuration {
+	BasicFeatureExtractor<BasicFrontEnd<Config>> extractor;
+	WordRecognizer<CompareVocabulary> recognizer;
+	std::vector<Word> words;
+	double seconds = 0;
+
+	explicit Configuration(const CompareVocabulary& vocabulary) : recognizer(vocabulary) {}
+
+	void addBlock(const int16_t* samples, latency::SampleIndex blockStart) {
+		const auto start = std::chrono::steady_clock::now();
+		extractor.addBlock(samples, audio::pcmToAdc, blockStart);
+		extractor.computeFeatures(true);
+		seconds += std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+		if (recognizer.addFrame(extractor.frame())) {
+			auto result = recognizer.recognize();
+			words.push_back({ result.commandIdx, result.cost, result.speechStart });
+		}
+	}
+};
+
+bool loadAudio(const char* path, uint32_t pcmRate, std::vector<int16_t>& samples) {
+	audio::Clip clip;
+	bool ok = audio::isWav(path) ? audio::readWav(path, clip) : audio::readPcm(path, pcmRate != 0 ? pcmRate : sampleRate, clip);
+	if (!ok) return false;
+	if (clip.sampleRate == uint32_t(sampleRate)) {
+		samples = std::move(clip.samples);
+	}
+	else {
+		PolyphaseResampler(clip.sampleRate, sampleRate).process(clip.samples, samples);
+	}
+	return true;
+}
+
+// The word a file is named after, the name up to the first '_' or '.'
+std::string label(const char* path) {
+	const char* name = std::strrchr(path, '/');
+	name = (name != nullptr) ? name + 1 : path;
+	return std::string(name, std::strcspn(name, "_."));
+}
+
+float distance(const FeatureVector& a, const FeatureVector& b) {
+	return dtw::distanceMetric(a, b) / 65536.0f;
+}
+
+const char* text(const CompareVocabulary& vocabulary, int commandIdx) {
+	return commandIdx >= 0 ? vocabulary[commandIdx].text : "-";
+}
+
+double milliseconds(latency::SampleIndex samples) {
+	return samples * 1000.0 / sampleRate;
+}
+
+}
+
+int main(int argc, char** argv) {
+	const char* templatesPath = nullptr;
+	uint32_t pcmRate = 0;
+	std::vector<const char*> paths;
+	for (int i = 1; i < argc; i++) {
+		if (std::strcmp(argv[i], "--templates") == 0 && i + 1 < argc) {
+			templatesPath = argv[++i];
+		}
+		else if (std::strcmp(argv[i], "--pcm-rate") == 0 && i + 1 < argc) {
+			pcmRate = std::strtoul(argv[++i], nullptr, 10);
+		}
+		else if (argv[i][0] != '-') {
+			paths.push_back(argv[i]);
+		}
+		else {
+			paths.clear();
+			break;
+		}
+	}
+	if (paths.empty()) {
+		std::fprintf(stderr, "usage: %s [--templates templates.bin] [--pcm-rate hz] <audio file>...\n", argv[0]);
+		return 1;
+	}
+
+	MappedTemplateFile templates;
+	CompareVocabulary vocabulary;
+	if (templatesPath != nullptr) {
+		templatedb::Error error;
+		if (!templates.open(templatesPath, error) || error != templatedb::Error::None
+				|| templates.database().check(featureVectorDim, maxTemplates, maxTemplateFrames) != templatedb::Error::None) {
+			std::fprintf(stderr, "could not use %s\n", templatesPath);
+			return 1;
+		}
+		const templatedb::Database& db = templates.database();
+		for (int i = 0; i < db.size(); i++) {
+			vocabulary.add(db.text(i), db.frames<featureVectorDim>(i), db.numFrames(i));
+		}
+	}
+
+	double referenceSeconds = 0;
+	double candidateSeconds = 0;
+	double featureDistance = 0;
+	double frameStep = 0;
+	double amplitudeDifference = 0;
+	double amplitudeSum = 0;
+	uint64_t numBlocks = 0;
+	uint64_t numWordFrames = 0;
+	int numReferenceWords = 0;
+	int numCandidateWords = 0;
+	int numAgreeing = 0;
+	int referenceCorrect = 0;
+	int candidateCorrect = 0;
+	bool labelled = false;
+
+	for (const char* path : paths) {
+		std::vector<int16_t> samples;
+		if (!loadAudio(path, pcmRate, samples)) {
+			std::fprintf(stderr, "could not read %s\n", path);
+			return 1;
+		}
+		auto reference = std::make_unique<Configuration<ReferenceConfig>>(vocabulary);
+		auto candidate = std::make_unique<Configuration<CandidateConfig>>(vocabulary);
+		FeatureVector previous = {};
+		for (size_t offset = 0; offset + windowStride <= samples.size(); offset += windowStride) {
+			reference->addBlock(samples.data() + offset, offset);
+			candidate->addBlock(samples.data() + offset, offset);
+			numBlocks += 1;
+
+			const float referenceAmplitude = reference->extractor.frontEnd().amplitude();
+			amplitudeDifference += std::abs(candidate->extractor.frontEnd().amplitude() - referenceAmplitude);
+			amplitudeSum += referenceAmplitude;
+			const FeatureFrame& frame = reference->extractor.frame();
+			if (frame.segment.storeFeatureVector) {
+				featureDistance += distance(frame.featureVector, candidate->extractor.frame().featureVector);
+				frameStep += distance(frame.featureVector, previous);
+				numWordFrames += 1;
+			}
+			previous = frame.featureVector;
+		}
+
+		// Words of the two configurations starting within a block of each other are the same word
+		const std::string expected = label(path);
+		std::printf("%s\n", path);
+		for (const Word& word : reference->words) {
+			auto match = std::find_if(candidate->words.begin(), candidate->words.end(), [&](const Word& other) {
+				return std::max(word.start, other.start) - std::min(word.start, other.start) <= latency::SampleIndex(windowStride);
+			});
+			std::printf("  %8.0f ms  reference: %-16s %8u", milliseconds(word.start), text(vocabulary, word.commandIdx), word.cost);
+			if (match != candidate->words.end()) {
+				std::printf("  candidate: %-16s %8u\n", text(vocabulary, match->commandIdx), match->cost);
+				numAgreeing += (match->commandIdx == word.commandIdx) ? 1 : 0;
+			}
+			else {
+				std::printf("  candidate: no word\n");
+			}
+		}
+		for (const Word& word : reference->words) {
+			const bool correct = word.commandIdx >= 0 && expected == vocabulary[word.commandIdx].text;
+			referenceCorrect += correct ? 1 : 0;
+		}
+		for (const Word& word : candidate->words) {
+			const bool correct = word.commandIdx >= 0 && expected == vocabulary[word.commandIdx].text;
+			candidateCorrect += correct ? 1 : 0;
+		}
+		for (int i = 0; i < vocabulary.size(); i++) {
+			labelled |= expected == vocabulary[i].text;
+		}
+		numReferenceWords += reference->words.size();
+		numCandidateWords += candidate->words.size();
+		referenceSeconds += reference->seconds;
+		candidateSeconds += candidate->seconds;
+	}
+
+	std::printf("features: mean distance %.4f within words, %.1f%% of the mean step between frames\n",
+		numWordFrames > 0 ? featureDistance / numWordFrames : 0.0,
+		frameStep > 0 ? 100 * featureDistance / frameStep : 0.0);
+	std::printf("amplitude: mean difference %.2f%% of the mean amplitude\n", amplitudeSum > 0 ? 100 * amplitudeDifference / amplitudeSum : 0.0);
+	std::printf("words: reference %d, candidate %d, same match %d\n", numReferenceWords, numCandidateWords, numAgreeing);
+	if (labelled) {
+		std::printf("correct: reference %d / %d, candidate %d / %d\n", referenceCorrect, numReferenceWords, candidateCorrect, numCandidateWords);
+	}
+	std::printf("time per block: reference %.0f ns, candidate %.0f ns, %.2fx\n",
+		referenceSeconds * 1e9 / std::max<uint64_t>(numBlocks, 1), candidateSeconds * 1e9 / std::max<uint64_t>(numBlocks, 1),
+		referenceSeconds / std::max(candidateSeconds, 1e-12));
+	return 0;
+}
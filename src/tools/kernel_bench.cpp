@@ -0,0 +1,376 @@
+// Benchmarks the front end's kernels against their straightforward versions.
+//
+// Runs each kernel over the FFT output of a set of random windows and reports
+// the time per frame and the largest difference of its output from the
+// reference. On the target the same kernels are timed by the profiler zones
+// of the prof telemetry stream.
+//
+// The errors are relative to the largest reference value of a frame.
+//
+// Then times each stage of the front end (app/front_end_stages.hpp) on its
+// own over windows of ADC counts, and the stages composed into one
+// stage::Chain, whose output must match running them one by one.
+//
+// Checks that the FFT tables of app/fft_plan.hpp give the same output as
+// CMSIS-DSP's for every size, and exits with 1 if they do not. The error
+// bounds of the fast log2 are checked by the fast_log2_test host test.
+//
+// Usage: kernel_bench [--iterations n]
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <random>
+#include <type_traits>
+#include <vector>
+
+#include "arm_math.h"
+
+#include <app/parameters.hpp>
+#include <app/feature_vector.hpp>
+#include <app/front_end.hpp>
+#include <app/fft_plan.hpp>
+#include <app/front_end_stages.hpp>
+#include <app/stage.hpp>
+#include <app/transform.hpp>
+#include <common/fast_math.hpp>
+
+namespace {
+
+constexpr int numWindows = 64;
+
+using Spectrum = std::array<float, FrontEnd::fftSize / 2>;
+using MelPower = std::array<float, numMelCoefficients>;
+
+// Keeps the compiler from dropping the benchmarked work
+volatile float sink;
+
+template<typename Kernel>
+double nanosecondsPerFrame(int iterations, Kernel kernel) {
+	const auto start = std::chrono::steady_clock::now();
+	for (int n = 0; n < iterations; n++) {
+		for (int w = 0; w < numWindows; w++) {
+			sink = sink + kernel(w);
+		}
+	}
+	const double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+	return seconds * 1e9 / (double(iterations) * numWindows);
+}
+
+// Largest difference relative to the largest reference value
+template<size_t N>
+double maxRelativeError(const std::array<float, N>& reference, const std::array<float, N>& value) {
+	double error = 0;
+	double magnitude = 1e-30;
+	for (size_t i = 0; i < N; i++) {
+		error = std::max(error, std::abs(double(value[i]) - reference[i]));
+		magnitude = std::max(magnitude, std::abs(double(reference[i])));
+	}
+	return error / magnitude;
+}
+
+void report(const char* name, double referenceNs, double kernelNs, double error) {
+	std::printf("%-10s reference %8.1f ns, kernel %8.1f ns, %.2fx, max relative error %.3g\n",
+		name, referenceNs, kernelNs, referenceNs / kernelNs, error);
+}
+
+// FastDctII against the table for a filterbank of N filters
+template<int N>
+void benchmarkFastDct(int iterations) {
+	static constexpr DiscreteCosineTransformTable<N> table{};
+	FastDctII<N> fastDct;
+	std::mt19937 random(N);
+	std::uniform_real_distribution<float> logPower(-10, 10);
+	std::vector<std::array<float, N>> input(numWindows);
+	for (auto& x : input) {
+		for (float& value : x) {
+			value = logPower(random);
+		}
+	}
+	std::vector<std::array<float, N>> reference(numWindows);
+	std::vector<std::array<float, N>> fast(numWindows);
+	const double referenceNs = nanosecondsPerFrame(iterations, [&](int w) {
+		for (int k = 0; k < N; k++) {
+			reference[w][k] = table.evaluate(input[w], k);
+		}
+		return reference[w][1];
+	});
+	const double fastNs = nanosecondsPerFrame(iterations, [&](int w) {
+		fastDct.evaluate(input[w], fast[w]);
+		return fast[w][1];
+	});
+	double error = 0;
+	for (int w = 0; w < numWindows; w++) {
+		error = std::max(error, maxRelativeError(reference[w], fast[w]));
+	}
+	char name[16];
+	std::snprintf(name, sizeof(name), "dct%d", N);
+	report(name, referenceNs, fastNs, error);
+}
+
+// The order arm_bitreversal_32 leaves n complex values in with a table
+std::vector<int> bitReversalOrder(const arm_cfft_instance_f32& settings) {
+	std::vector<int> order(settings.fftLen);
+	for (size_t i = 0; i < order.size(); i++) {
+		order[i] = int(i);
+	}
+	for (int i = 0; i < settings.bitRevLength; i += 2) {
+		std::swap(order[settings.pBitRevTable[i] / 8], order[settings.pBitRevTable[i + 1] / 8]);
+	}
+	return order;
+}
+
+template<typename T>
+double maxDifference(const T* reference, const T* value, int n) {
+	double difference = 0;
+	for (int i = 0; i < n; i++) {
+		difference = std::max(difference, std::abs(double(value[i]) - reference[i]));
+	}
+	return difference;
+}
+
+// The compile-time tables of fft::RealPlan<N> against those
+// arm_rfft_fast_init_f32 picks, and arm_rfft_fast_f32's output with each,
+// which must be the same to the bit
+template<int N>
+bool checkFftPlan() {
+	static constexpr fft::RealPlan<N> plan{};
+	arm_rfft_fast_instance_f32 planSettings = plan.settings();
+	arm_rfft_fast_instance_f32 cmsisSettings;
+	arm_rfft_fast_init_f32(&cmsisSettings, N);
+
+	// The swaps may come in another order, but must leave the same one
+	const bool sameOrder = planSettings.Sint.bitRevLength == cmsisSettings.Sint.bitRevLength
+		&& bitReversalOrder(planSettings.Sint) == bitReversalOrder(cmsisSettings.Sint);
+	const double twiddleError = std::max(
+		maxDifference(cmsisSettings.Sint.pTwiddle, planSettings.Sint.pTwiddle, N),
+		maxDifference(cmsisSettings.pTwiddleRFFT, planSettings.pTwiddleRFFT, N));
+
+	std::mt19937 random(N);
+	std::normal_distribution<float> noise(0, 0.2f);
+	double error = 0;
+	int identical = 0;
+	for (int w = 0; w < numWindows; w++) {
+		std::array<float, N> samples;
+		for (float& sample : samples) {
+			sample = noise(random);
+		}
+		// Both use their input as scratch
+		std::array<float, N> planInput = samples;
+		std::array<float, N> reference;
+		std::array<float, N> output;
+		arm_rfft_fast_f32(&cmsisSettings, samples.data(), reference.data(), 0);
+		arm_rfft_fast_f32(&planSettings, planInput.data(), output.data(), 0);
+		error = std::max(error, maxRelativeError(reference, output));
+		identical += reference == output;
+	}
+
+	const bool ok = sameOrder && identical == numWindows;
+	std::printf("fft%-6d %4d swaps, %s order, twiddles within %.2g, max relative error %.3g, %d of %d identical%s\n",
+		N, plan.bitReversalLength / 2, sameOrder ? "same" : "DIFFERENT", twiddleError, error, identical, numWindows,
+		ok ? "" : " FAIL");
+	return ok;
+}
+
+template<int Degree>
+void benchmarkLog2(int iterations, const std::vector<MelPower>& melPower) {
+	std::vector<MelPower> reference(numWindows);
+	std::vector<MelPower> fast(numWindows);
+	const double referenceNs = nanosecondsPerFrame(iterations, [&](int w) {
+		for (int i = 0; i < numMelCoefficients; i++) {
+			reference[w][i] = std::log2f(melPower[w][i]);
+		}
+		return reference[w][0];
+	});
+	const double fastNs = nanosecondsPerFrame(iterations, [&](int w) {
+		for (int i = 0; i < numMelCoefficients; i++) {
+			fast[w][i] = fastmath::log2<Degree>(melPower[w][i]);
+		}
+		return fast[w][0];
+	});
+	double error = 0;
+	for (int w = 0; w < numWindows; w++) {
+		error = std::max(error, maxRelativeError(reference[w], fast[w]));
+	}
+	char name[16];
+	std::snprintf(name, sizeof(name), "log2 d%d", Degree);
+	report(name, referenceNs, fastNs, error);
+}
+
+// Runs a stage over one input per window and reports the time per frame. A
+// stage that uses its input as scratch gets a fresh copy each time.
+template<typename Stage>
+std::vector<typename Stage::Output> benchmarkStage(const char* name, int iterations, const std::vector<typename Stage::Input>& inputs) {
+	Stage stage;
+	std::vector<typename Stage::Output> outputs(numWindows);
+	const double ns = nanosecondsPerFrame(iterations, [&](int w) {
+		if constexpr (std::is_invocable_v<decltype(&Stage::process), Stage&, const typename Stage::Input&, typename Stage::Output&>) {
+			stage.process(inputs[w], outputs[w]);
+		}
+		else {
+			auto input = inputs[w];
+			stage.process(input, outputs[w]);
+		}
+		return outputs[w][0];
+	});
+	std::printf("%-10s %8.1f ns\n", name, ns);
+	return outputs;
+}
+
+}
+
+int main(int argc, char** argv) {
+	int iterations = 2000;
+	for (int i = 1; i < argc; i++) {
+		if (std::strcmp(argv[i], "--iterations") == 0 && i + 1 < argc) {
+			iterations = std::max(1, std::atoi(argv[++i]));
+		}
+		else {
+			std::fprintf(stderr, "usage: %s [--iterations n]\n", argv[0]);
+			return 1;
+		}
+	}
+
+	// FFT output of windows of noise with a random tilt, like normalized samples
+	std::mt19937 random(1);
+	std::normal_distribution<float> noise(0, 0.2f);
+	arm_rfft_fast_instance_f32 fftSettings;
+	arm_rfft_fast_init_f32(&fftSettings, FrontEnd::fftSize);
+	std::vector<std::array<float, FrontEnd::fftSize>> fftOutput(numWindows);
+	for (auto& output : fftOutput) {
+		std::array<float, FrontEnd::fftSize> samples;
+		float previous = 0;
+		const float tilt = std::uniform_real_distribution<float>(0, 0.9f)(random);
+		for (float& sample : samples) {
+			previous = noise(random) + tilt * previous;
+			sample = previous;
+		}
+		arm_rfft_fast_f32(&fftSettings, samples.data(), output.data(), 0);
+	}
+
+	static constexpr FrontEnd::MelFilterbank melFilterbank{};
+
+	// Power spectrum and filterbank
+	{
+		std::vector<MelPower> reference(numWindows);
+		std::vector<MelPower> fused(numWindows);
+		std::vector<MelPower> unrolled(numWindows);
+		const double referenceNs = nanosecondsPerFrame(iterations, [&](int w) {
+			Spectrum spectrum;
+			arm_cmplx_mag_squared_f32(fftOutput[w].data(), spectrum.data(), FrontEnd::fftSize / 2);
+			for (int i = 1; i <= numMelCoefficients; i++) {
+				reference[w][i - 1] = melFilterbank.evaluate(spectrum, i);
+			}
+			return reference[w][0];
+		});
+		const double fusedNs = nanosecondsPerFrame(iterations, [&](int w) {
+			melFilterbank.evaluatePower(fftOutput[w].data(), fused[w]);
+			return fused[w][0];
+		});
+		const double unrolledNs = nanosecondsPerFrame(iterations, [&](int w) {
+			mfcc::UnrolledMelFilterbank<melFilterbank>::evaluatePower(fftOutput[w].data(), unrolled[w]);
+			return unrolled[w][0];
+		});
+		double fusedError = 0;
+		double unrolledError = 0;
+		for (int w = 0; w < numWindows; w++) {
+			fusedError = std::max(fusedError, maxRelativeError(reference[w], fused[w]));
+			unrolledError = std::max(unrolledError, maxRelativeError(fused[w], unrolled[w]));
+		}
+		std::printf("mel filterbank: bins %d to %d of %d\n", FrontEnd::MelFilterbank::firstBin,
+			FrontEnd::MelFilterbank::endBin - 1, FrontEnd::fftSize / 2);
+		report("mag+mel", referenceNs, fusedNs, fusedError);
+		// Against the loop, which LPSR_UNROLLED_MEL replaces
+		report("unrolled", fusedNs, unrolledNs, unrolledError);
+	}
+
+	// Feature vector from the log mel spectrum
+	{
+		static constexpr FrontEnd::CepstrumDctTable cepstrumDct{};
+		static constexpr FrontEnd::FeatureDctTable featureDct{};
+		std::vector<MelPower> melPower(numWindows);
+		for (int w = 0; w < numWindows; w++) {
+			melFilterbank.evaluatePower(fftOutput[w].data(), melPower[w]);
+			for (float& power : melPower[w]) {
+				power = std::log2f(power);
+			}
+		}
+		std::vector<FeatureVector> reference(numWindows);
+		std::vector<FeatureVector> truncated(numWindows);
+		const double referenceNs = nanosecondsPerFrame(iterations, [&](int w) {
+			MelPower cepstrum;
+			for (int i = 0; i < numMelCoefficients; i++) {
+				cepstrum[i] = cepstrumDct.evaluate(melPower[w], i);
+			}
+			computeFeatureVector(cepstrum, reference[w]);
+			return reference[w][0];
+		});
+		const double truncatedNs = nanosecondsPerFrame(iterations, [&](int w) {
+			computeFeatureVector(featureDct, melPower[w], truncated[w]);
+			return truncated[w][0];
+		});
+		double error = 0;
+		for (int w = 0; w < numWindows; w++) {
+			error = std::max(error, maxRelativeError(reference[w], truncated[w]));
+		}
+		report("dct+fvscl", referenceNs, truncatedNs, error);
+	}
+
+	// The FFT based DCT for larger filterbanks
+	benchmarkFastDct<32>(iterations);
+	benchmarkFastDct<64>(iterations);
+	benchmarkFastDct<128>(iterations);
+
+	// The log of the mel energies, against std::log2f
+	{
+		std::vector<MelPower> melPower(numWindows);
+		for (int w = 0; w < numWindows; w++) {
+			melFilterbank.evaluatePower(fftOutput[w].data(), melPower[w]);
+		}
+		benchmarkLog2<3>(iterations, melPower);
+		benchmarkLog2<5>(iterations, melPower);
+		benchmarkLog2<7>(iterations, melPower);
+	}
+
+	// The front end's stages, one by one and chained
+	{
+		using namespace frontend;
+		std::vector<Window<Pipeline>> windows(numWindows);
+		std::normal_distribution<float> adcNoise(0, 200);
+		for (auto& window : windows) {
+			for (uint16_t& sample : window) {
+				sample = static_cast<uint16_t>(std::clamp(2048.0f + adcNoise(random), 0.0f, 4095.0f));
+			}
+		}
+		std::printf("stages:\n");
+		auto normalized = benchmarkStage<Normalize<Pipeline>>("normalize", iterations, windows);
+		auto spectrum = benchmarkStage<RealFft<Pipeline>>("fft", iterations, normalized);
+		auto melPower = benchmarkStage<LogMelPower<Pipeline>>("log mel", iterations, spectrum);
+		benchmarkStage<Cepstrum<Pipeline>>("cepstrum", iterations, melPower);
+		auto features = benchmarkStage<Features<Pipeline>>("features", iterations, melPower);
+		using Chained = stage::Chain<Normalize<Pipeline>, RealFft<Pipeline>, LogMelPower<Pipeline>, Features<Pipeline>>;
+		auto chained = benchmarkStage<Chained>("chain", iterations, windows);
+		for (int w = 0; w < numWindows; w++) {
+			if (chained[w] != features[w]) {
+				std::printf("FAIL: the chain's features differ from the stages' in window %d\n", w);
+				return 1;
+			}
+		}
+	}
+
+	// The real FFT's tables of every size arm_rfft_fast_f32 has
+	std::printf("fft plans against arm_rfft_fast_init_f32:\n");
+	bool ok = checkFftPlan<32>();
+	ok &= checkFftPlan<64>();
+	ok &= checkFftPlan<128>();
+	ok &= checkFftPlan<256>();
+	ok &= checkFftPlan<512>();
+	ok &= checkFftPlan<1024>();
+	ok &= checkFftPlan<2048>();
+	ok &= checkFftPlan<4096>();
+
+	return ok ? 0 : 1;
+}
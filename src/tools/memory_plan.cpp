@@ -0,0 +1,83 @@
+// Reports the RAM of the pipeline's buffers: the front end's frame buffers
+// as the FramePlan places them (see common/arena.hpp), with their peak
+// footprint against separate buffers, and the recognizer's word buffer and
+// DTW rows. The host build runs it after building it, so every build
+// reports the plan.
+//
+// Then runs a front end over noise the way the firmware does, which aborts
+// if a frame buffer is read after its memory was reused.
+//
+// Usage: memory_plan
+
+#include <algorithm>
+#include <array>
+#include <cstdint>
+#include <cstdio>
+#include <iterator>
+#include <random>
+
+#include <app/parameters.hpp>
+#include <app/pipeline_config.hpp>
+#include <app/front_end.hpp>
+#include <app/recognizer.hpp>
+
+namespace {
+
+// Keeps the compiler from dropping the frames
+volatile float sink;
+
+template<typename Config>
+void reportFramePlan(const char* name) {
+	using Plan = typename BasicFrontEnd<Config>::FramePlan;
+	static constexpr const char* bufferNames[] = { "normalized", "fft", "mel power", "cepstrum" };
+	static_assert(std::size(bufferNames) == Plan::numBuffers);
+
+	std::printf("front end frame, %s:\n", name);
+	for (size_t i = 0; i < Plan::numBuffers; i++) {
+		std::printf("  %-12s %6zu bytes at %6zu, steps %d to %d\n", bufferNames[i], Plan::bufferSize(i), Plan::offsets[i],
+			Plan::firstStep(i), Plan::lastStep(i));
+	}
+	std::printf("  peak %zu bytes, separately %zu bytes, %zu bytes reused\n", Plan::size, Plan::separateSize,
+		Plan::separateSize - Plan::size);
+}
+
+}
+
+int main() {
+	reportFramePlan<PipelineConfig<DefaultPipelineSettings>>("full rate");
+	reportFramePlan<PipelineConfig<DecimatedPipelineSettings>>("decimated");
+
+	// As in WordRecognizer
+	constexpr size_t wordBytes = maxWords * (sizeof(FeatureVector) + sizeof(latency::SampleIndex));
+	constexpr size_t dtwBytes = sizeof(Dtw<Pipeline::dtwFrames, FeatureVector>);
+	constexpr size_t matrixBytes = size_t(Pipeline::dtwFrames) * Pipeline::dtwFrames * sizeof(uint32_t);
+	std::printf("recognizer:\n");
+	std::printf("  word buffer  %6zu bytes, %d frames\n", wordBytes, maxWords);
+	std::printf("  dtw rows     %6zu bytes, the whole cost matrix would take %zu bytes\n", dtwBytes, matrixBytes);
+
+	// Both paths of the feature extraction and every reader of a frame
+	std::mt19937 random(1);
+	std::normal_distribution<float> noise(2048, 200);
+	FrontEnd frontEnd;
+	std::array<uint16_t, windowStride> block;
+	std::array<float, FrontEnd::fftSize / 2> spectrum;
+	FeatureVector featureVector;
+	for (int n = 0; n < 16; n++) {
+		for (uint16_t& sample : block) {
+			sample = static_cast<uint16_t>(std::clamp(noise(random), 0.0f, 4095.0f));
+		}
+		frontEnd.addBlock(block.data());
+		if (n % 2 == 0) {
+			frontEnd.computeCepstrum();
+			sink = frontEnd.cepstrum()[1];
+		}
+		else {
+			frontEnd.computeFeatureVector(featureVector);
+			sink = featureVector[0];
+		}
+		frontEnd.computeSpectrum(spectrum);
+		sink = spectrum[1];
+	}
+	std::printf("no frame buffer was read after its memory was reused\n");
+	return 0;
+}
@@ -0,0 +1,72 @@
+// Converts recorded sessions between feature logs, raw PCM and binary session files.
+//
+// Any session the host tools read (feature log, .pcm or .lps) is written as a
+// binary session file (.lps) with its word index, or as a feature log with
+// every float printed exactly (any other extension).
+//
+// Usage: session_convert <session> <output.lps|output.txt>
+
+#include <cstdio>
+#include <vector>
+
+#include <host/session_file.hpp>
+#include <host/session_reader.hpp>
+
+namespace {
+
+bool writeFeatureLog(const char* path, const std::vector<featurelog::Frame>& frames) {
+	FILE* file = std::fopen(path, "w");
+	if (file == nullptr) return false;
+	for (const featurelog::Frame& frame : frames) {
+		// 9 significant digits round-trip a float
+		std::fprintf(file, "mfcc:%.9g", frame.rmsAmplitude);
+		for (int k = 1; k < featurelog::numCoefficients; k++) {
+			std::fprintf(file, " %.9g", frame.cepstrum[k]);
+		}
+		std::fprintf(file, "\n");
+	}
+	return std::fclose(file) == 0;
+}
+
+}
+
+int main(int argc, char** argv) {
+	if (argc != 3) {
+		std::fprintf(stderr, "usage: %s <session> <output.lps|output.txt>\n", argv[0]);
+		return 1;
+	}
+
+	SessionReader reader;
+	if (!reader.open(argv[1])) {
+		std::fprintf(stderr, "could not read %s\n", argv[1]);
+		return 1;
+	}
+	std::vector<featurelog::Frame> frames;
+	featurelog::Frame frame;
+	while (reader.next(frame)) {
+		frames.push_back(frame);
+	}
+
+	bool ok = sessionfile::isSessionFile(argv[2]) ? sessionfile::write(argv[2], frames) : writeFeatureLog(argv[2], frames);
+	if (!ok) {
+		std::fprintf(stderr, "could not write %s\n", argv[2]);
+		return 1;
+	}
+
+	if (sessionfile::isSessionFile(argv[2])) {
+		sessionfile::MappedSession session;
+		if (!session.open(argv[2])) {
+			std::fprintf(stderr, "could not read back %s\n", argv[2]);
+			return 1;
+		}
+		std::printf("%u frames, %d words\n", static_cast<unsigned>(session.numFrames()), session.numWords());
+		for (int w = 0; w < session.numWords(); w++) {
+			std::printf("word %2d: frames %5u to %5u\n", w, static_cast<unsigned>(session.word(w).firstFrame),
+				static_cast<unsigned>(session.word(w).firstFrame + session.word(w).numFrames - 1));
+		}
+	}
+	else {
+		std::printf("%zu frames\n", frames.size());
+	}
+	return 0;
+}
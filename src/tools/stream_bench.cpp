@@ -0,0 +1,148 @@
+// Measures the cost of one stream of the C API in host/lpsr.h.
+//
+// Feeds the same audio to many streams in chunks, round robin like a gateway
+// serving many devices, and reports the CPU time per stream: per block, per
+// second of audio and how many real-time streams one core can serve. Without
+// an audio file a synthetic signal with a word-like burst every second is used.
+//
+// Usage: stream_bench [audio.wav|audio.pcm] [--streams n] [--templates templates.bin] [--chunk samples] [--frames]
+
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <memory>
+#include <random>
+#include <vector>
+
+#include <host/audio_file.hpp>
+#include <host/lpsr.h>
+#include <host/resampler.hpp>
+
+namespace {
+
+bool loadAudio(const char* path, std::vector<int16_t>& samples) {
+	audio::Clip clip;
+	bool ok = audio::isWav(path) ? audio::readWav(path, clip) : audio::readPcm(path, LPSR_SAMPLE_RATE, clip);
+	if (!ok) return false;
+	if (clip.sampleRate == LPSR_SAMPLE_RATE) {
+		samples = std::move(clip.samples);
+	}
+	else {
+		PolyphaseResampler(clip.sampleRate, LPSR_SAMPLE_RATE).process(clip.samples, samples);
+	}
+	return true;
+}
+
+// 10 s of quiet noise with a 400 ms two-tone burst every second
+void syntheticAudio(std::vector<int16_t>& samples) {
+	std::mt19937 random(1);
+	std::normal_distribution<float> noise(0, 30);
+	samples.resize(10 * LPSR_SAMPLE_RATE);
+	for (size_t i = 0; i < samples.size(); i++) {
+		const float t = float(i) / LPSR_SAMPLE_RATE;
+		const bool burst = std::fmod(t, 1.0f) > 0.3f && std::fmod(t, 1.0f) < 0.7f;
+		const float tone = burst ? 6000 * (std::sin(2 * M_PI * 440 * t) + 0.5f * std::sin(2 * M_PI * 1320 * t)) : 0;
+		samples[i] = static_cast<int16_t>(tone + noise(random));
+	}
+}
+
+bool readFile(const char* path, std::vector<uint8_t>& bytes) {
+	FILE* file = std::fopen(path, "rb");
+	if (file == nullptr) return false;
+	uint8_t buffer[4096];
+	size_t count;
+	while ((count = std::fread(buffer, 1, sizeof(buffer), file)) > 0) {
+		bytes.insert(bytes.end(), buffer, buffer + count);
+	}
+	std::fclose(file);
+	return true;
+}
+
+}
+
+int main(int argc, char** argv) {
+	const char* audioPath = nullptr;
+	const char* templatesPath = nullptr;
+	int numStreams = 64;
+	size_t chunkSamples = 320;
+	unsigned flags = 0;
+	for (int i = 1; i < argc; i++) {
+		if (std::strcmp(argv[i], "--streams") == 0 && i + 1 < argc) {
+			numStreams = std::max(1, std::atoi(argv[++i]));
+		}
+		else if (std::strcmp(argv[i], "--templates") == 0 && i + 1 < argc) {
+			templatesPath = argv[++i];
+		}
+		else if (std::strcmp(argv[i], "--chunk") == 0 && i + 1 < argc) {
+			chunkSamples = std::max(1, std::atoi(argv[++i]));
+		}
+		else if (std::strcmp(argv[i], "--frames") == 0) {
+			flags |= LPSR_FRAMES;
+		}
+		else if (argv[i][0] != '-' && audioPath == nullptr) {
+			audioPath = argv[i];
+		}
+		else {
+			std::fprintf(stderr, "usage: %s [audio] [--streams n] [--templates templates.bin] [--chunk samples] [--frames]\n", argv[0]);
+			return 1;
+		}
+	}
+
+	std::vector<int16_t> samples;
+	if (audioPath == nullptr) {
+		syntheticAudio(samples);
+	}
+	else if (!loadAudio(audioPath, samples)) {
+		std::fprintf(stderr, "could not read %s\n", audioPath);
+		return 1;
+	}
+	std::vector<uint8_t> templates;
+	if (templatesPath != nullptr && !readFile(templatesPath, templates)) {
+		std::fprintf(stderr, "could not read %s\n", templatesPath);
+		return 1;
+	}
+
+	// All streams in one caller-owned block
+	const size_t alignment = lpsr_state_alignment();
+	const size_t stride = (lpsr_state_size() + alignment - 1) / alignment * alignment;
+	std::unique_ptr<void, decltype(&std::free)> memory(std::aligned_alloc(alignment, stride * numStreams), &std::free);
+	std::vector<lpsr_state*> streams(numStreams);
+	for (int s = 0; s < numStreams; s++) {
+		lpsr_status status = lpsr_init(static_cast<uint8_t*>(memory.get()) + s * stride, stride,
+			templates.empty() ? nullptr : templates.data(), templates.size(), flags, &streams[s]);
+		if (status != LPSR_OK) {
+			std::fprintf(stderr, "%s\n", lpsr_status_name(status));
+			return 1;
+		}
+	}
+
+	std::vector<lpsr_frame> frames(64);
+	uint64_t numEvents = 0;
+	const auto start = std::chrono::steady_clock::now();
+	for (size_t offset = 0; offset < samples.size(); offset += chunkSamples) {
+		const size_t count = std::min(chunkSamples, samples.size() - offset);
+		for (lpsr_state* stream : streams) {
+			size_t consumed = 0;
+			while (consumed < count) {
+				consumed += lpsr_push(stream, samples.data() + offset + consumed, count - consumed);
+				while (lpsr_pull_frames(stream, frames.data(), frames.size()) > 0) {}
+				lpsr_event event;
+				while (lpsr_pull_event(stream, &event)) {
+					numEvents += 1;
+				}
+			}
+		}
+	}
+	const double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+	const double audioSeconds = double(samples.size()) / LPSR_SAMPLE_RATE;
+	const double secondsPerStream = seconds / numStreams;
+	const double blocks = double(samples.size() / LPSR_BLOCK_SIZE);
+	std::printf("%d streams of %.1f s, %zu bytes of state each, %llu words\n",
+		numStreams, audioSeconds, lpsr_state_size(), static_cast<unsigned long long>(numEvents / numStreams));
+	std::printf("per stream: %.2f us per block, %.1f us per second of audio, %.0fx real time (real-time streams per core)\n",
+		secondsPerStream / blocks * 1e6, secondsPerStream / audioSeconds * 1e6, audioSeconds / secondsPerStream);
+	return 0;
+}
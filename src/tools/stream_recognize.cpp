@@ -0,0 +1,124 @@
+// Recognizes words in a stream of PCM read from stdin, through the C API in host/lpsr.h.
+//
+// Reads 16 bit signed little endian mono PCM at 9.65 kHz, e.g. from a pipe
+//
+//     ffmpeg -i input.wav -f s16le -ac 1 -ar 9650 - | stream_recognize --templates templates.bin
+//
+// and prints a line for every recognized word as soon as it is decided, with
+// --frames also the feature frames in the format of the mfcc stream.
+//
+// Usage: stream_recognize --templates templates.bin [--frames] [--chunk samples]
+
+#include <algorithm>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <memory>
+#include <vector>
+
+#include <unistd.h>
+
+#include <host/lpsr.h>
+
+namespace {
+
+bool readFile(const char* path, std::vector<uint8_t>& bytes) {
+	FILE* file = std::fopen(path, "rb");
+	if (file == nullptr) return false;
+	uint8_t buffer[4096];
+	size_t count;
+	while ((count = std::fread(buffer, 1, sizeof(buffer), file)) > 0) {
+		bytes.insert(bytes.end(), buffer, buffer + count);
+	}
+	std::fclose(file);
+	return true;
+}
+
+double samplesToMilliseconds(uint32_t samples) {
+	return samples * 1000.0 / LPSR_SAMPLE_RATE;
+}
+
+void printOutput(lpsr_state* state, bool printFrames) {
+	if (printFrames) {
+		lpsr_frame frames[16];
+		size_t count;
+		while ((count = lpsr_pull_frames(state, frames, 16)) > 0) {
+			for (size_t i = 0; i < count; i++) {
+				std::printf("mfcc:%g", frames[i].rms_amplitude);
+				for (int k = 1; k < LPSR_NUM_COEFFICIENTS; k++) {
+					std::printf(" %g", frames[i].cepstrum[k]);
+				}
+				std::printf("\n");
+			}
+		}
+	}
+	lpsr_event event;
+	while (lpsr_pull_event(state, &event)) {
+		std::printf("word: %s cost: %u frames: %u start: %.0f ms end: %.0f ms latency: %.0f ms\n",
+			event.template_index >= 0 ? event.text : "-", event.cost, event.num_frames,
+			samplesToMilliseconds(event.speech_start), samplesToMilliseconds(event.speech_end),
+			samplesToMilliseconds(event.decision - event.speech_end));
+	}
+	std::fflush(stdout);
+}
+
+}
+
+int main(int argc, char** argv) {
+	const char* templatesPath = nullptr;
+	bool printFrames = false;
+	size_t chunkSamples = 1024;
+	for (int i = 1; i < argc; i++) {
+		if (std::strcmp(argv[i], "--templates") == 0 && i + 1 < argc) {
+			templatesPath = argv[++i];
+		}
+		else if (std::strcmp(argv[i], "--frames") == 0) {
+			printFrames = true;
+		}
+		else if (std::strcmp(argv[i], "--chunk") == 0 && i + 1 < argc) {
+			chunkSamples = std::max(1, std::atoi(argv[++i]));
+		}
+		else {
+			std::fprintf(stderr, "usage: %s --templates templates.bin [--frames] [--chunk samples] < audio.pcm\n", argv[0]);
+			return 1;
+		}
+	}
+
+	std::vector<uint8_t> templates;
+	if (templatesPath != nullptr && !readFile(templatesPath, templates)) {
+		std::fprintf(stderr, "could not read %s\n", templatesPath);
+		return 1;
+	}
+
+	// The library does not allocate, the stream lives in memory owned here
+	const size_t alignment = lpsr_state_alignment();
+	std::unique_ptr<void, decltype(&std::free)> memory(
+		std::aligned_alloc(alignment, (lpsr_state_size() + alignment - 1) / alignment * alignment), &std::free);
+	lpsr_state* state;
+	lpsr_status status = lpsr_init(memory.get(), lpsr_state_size(), templates.empty() ? nullptr : templates.data(),
+		templates.size(), printFrames ? LPSR_FRAMES : 0, &state);
+	if (status != LPSR_OK) {
+		std::fprintf(stderr, "%s: %s\n", templatesPath, lpsr_status_name(status));
+		return 1;
+	}
+
+	std::vector<int16_t> chunk(chunkSamples);
+	size_t buffered = 0;
+	while (true) {
+		// A pipe may return any number of bytes, keep partial samples for the next read
+		ssize_t count = ::read(STDIN_FILENO, reinterpret_cast<uint8_t*>(chunk.data()) + buffered, chunkSamples * sizeof(int16_t) - buffered);
+		if (count <= 0) break;
+		buffered += count;
+		const size_t numSamples = buffered / sizeof(int16_t);
+		size_t consumed = 0;
+		while (consumed < numSamples) {
+			consumed += lpsr_push(state, chunk.data() + consumed, numSamples - consumed);
+			printOutput(state, printFrames);
+		}
+		const size_t remainder = buffered % sizeof(int16_t);
+		std::memmove(chunk.data(), reinterpret_cast<uint8_t*>(chunk.data()) + numSamples * sizeof(int16_t), remainder);
+		buffered = remainder;
+	}
+	printOutput(state, printFrames);
+	return 0;
+}
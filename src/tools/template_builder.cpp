@@ -0,0 +1,97 @@
+// Builds the template database from recorded sessions.
+//
+// Every session is segmented with the firmware's word segmenter and feature
+// vector scaling, the n-th word spoken in a session becomes a template named
+// after the n-th line of the word list. Sessions are processed in parallel.
+//
+// Usage: template_builder [--words words.txt] [-o templates.bin] [--source voice_command_data.cpp] <session>...
+
+#include <cstdio>
+#include <cstring>
+#include <string>
+#include <vector>
+
+#include <app/parameters.hpp>
+#include <app/feature_vector.hpp>
+#include <host/segmentation.hpp>
+#include <host/template_writer.hpp>
+#include <host/thread_pool.hpp>
+
+int main(int argc, char** argv) {
+	const char* wordListPath = "data/words.txt";
+	const char* binaryPath = nullptr;
+	const char* sourcePath = nullptr;
+	std::vector<const char*> sessions;
+	for (int i = 1; i < argc; i++) {
+		if (std::strcmp(argv[i], "--words") == 0 && i + 1 < argc) {
+			wordListPath = argv[++i];
+		}
+		else if (std::strcmp(argv[i], "-o") == 0 && i + 1 < argc) {
+			binaryPath = argv[++i];
+		}
+		else if (std::strcmp(argv[i], "--source") == 0 && i + 1 < argc) {
+			sourcePath = argv[++i];
+		}
+		else if (argv[i][0] != '-') {
+			sessions.push_back(argv[i]);
+		}
+		else {
+			std::fprintf(stderr, "unknown argument: %s\n", argv[i]);
+			return 1;
+		}
+	}
+	if (sessions.empty() || (binaryPath == nullptr && sourcePath == nullptr)) {
+		std::fprintf(stderr, "usage: %s [--words words.txt] [-o templates.bin] [--source file.cpp] <session>...\n", argv[0]);
+		return 1;
+	}
+
+	std::vector<std::string> wordList;
+	if (!segmentation::readWordList(wordListPath, wordList)) {
+		std::fprintf(stderr, "could not read %s\n", wordListPath);
+		return 1;
+	}
+
+	// std::vector<bool> is not safe to write from several threads
+	std::vector<char> ok(sessions.size());
+	std::vector<std::vector<segmentation::Word>> results(sessions.size());
+	ThreadPool pool;
+	for (size_t i = 0; i < sessions.size(); i++) {
+		pool.submit([&, i] { ok[i] = segmentation::segmentSession(sessions[i], results[i]); });
+	}
+	pool.wait();
+
+	std::vector<templatedb::Template> templates;
+	for (size_t i = 0; i < sessions.size(); i++) {
+		if (!ok[i]) {
+			std::fprintf(stderr, "could not read %s\n", sessions[i]);
+			return 1;
+		}
+		const std::vector<segmentation::Word>& words = results[i];
+		if (words.size() != wordList.size()) {
+			std::fprintf(stderr, "warning: %s has %zu words, the word list %zu\n", sessions[i], words.size(), wordList.size());
+		}
+		for (size_t w = 0; w < words.size() && w < wordList.size(); w++) {
+			templates.push_back(templatedb::Template{ wordList[w], words[w] });
+			std::printf("%-16s %3zu frames  %s\n", wordList[w].c_str(), words[w].size(), sessions[i]);
+		}
+	}
+	if (templates.size() > size_t(maxTemplates)) {
+		std::fprintf(stderr, "warning: %zu templates, the firmware only accepts %d\n", templates.size(), maxTemplates);
+	}
+
+	std::vector<uint8_t> database;
+	if (!templatedb::pack(templates, database)) {
+		std::fprintf(stderr, "template text longer than %d characters\n", templatedb::maxTextLength);
+		return 1;
+	}
+	if (binaryPath != nullptr && !templatedb::writeBinary(binaryPath, database)) {
+		std::fprintf(stderr, "could not write %s\n", binaryPath);
+		return 1;
+	}
+	if (sourcePath != nullptr && !templatedb::writeSource(sourcePath, database)) {
+		std::fprintf(stderr, "could not write %s\n", sourcePath);
+		return 1;
+	}
+	std::printf("%zu templates, %zu bytes\n", templates.size(), database.size());
+	return 0;
+}
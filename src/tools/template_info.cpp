@@ -0,0 +1,41 @@
+// Checks a template database file and lists the templates in it.
+//
+// Usage: template_info <templates.bin>
+
+#include <cstdio>
+
+#include <app/parameters.hpp>
+#include <app/template_db.hpp>
+#include <host/template_file.hpp>
+
+int main(int argc, char** argv) {
+	if (argc != 2) {
+		std::fprintf(stderr, "usage: %s <templates.bin>\n", argv[0]);
+		return 1;
+	}
+
+	MappedTemplateFile file;
+	templatedb::Error error;
+	if (!file.open(argv[1], error)) {
+		std::fprintf(stderr, "could not read %s\n", argv[1]);
+		return 1;
+	}
+	if (error != templatedb::Error::None) {
+		std::fprintf(stderr, "%s: %s\n", argv[1], templatedb::errorName(error));
+		return 1;
+	}
+
+	const templatedb::Database& db = file.database();
+	std::printf("%d templates, %d-dimensional feature vectors, %u bytes\n",
+		db.size(), db.featureVectorDim(), static_cast<unsigned>(db.totalSize()));
+	for (int i = 0; i < db.size(); i++) {
+		std::printf("%-16s %3d frames\n", db.text(i), db.numFrames(i));
+	}
+
+	error = db.check(featureVectorDim, maxTemplates, maxTemplateFrames);
+	if (error != templatedb::Error::None) {
+		std::printf("not usable by the firmware: %s\n", templatedb::errorName(error));
+		return 1;
+	}
+	return 0;
+}